@@ -0,0 +1,33 @@
+#include "generator.h"
+#include "rank.h"
+
+bool BmfGenerator::generate(Target& target, bool unique, long limit) {
+    if (unique && mode == GF2 && r > 1) return false;
+    std::bernoulli_distribution in(density);
+    auto mask = [&] {
+        Row bits = 0;
+        for (int i = 0; i < n; i++)
+            if (in(rng)) bits |= Row(1 << i);
+        return bits;
+    };
+    for (long attempt = 0; attempt < limit; attempt++) {
+        attempts++;
+        Factors factors;
+        for (int k = 0; k < r; k++) {
+            factors.u.push_back(mask());
+            factors.v.push_back(mask());
+        }
+        target.m = factors.product(n, mode);
+        target.r = r;
+        target.mode = mode;
+
+        if (mode == GF2) {
+            if (gf2Rank(target.m) == r) return true;
+            continue;
+        }
+        // A Boolean rank below r shows up before the search reaches r
+        BooleanRank rank(target.m);
+        if (rank.rank(r) == r && (!unique || rank.unique())) return true;
+    }
+    return false;
+}
@@ -0,0 +1,26 @@
+#pragma once
+#include "matrix.h"
+#include <random>
+
+// Target generator: r random products as web/bmf/script.js builds them
+// (every row and column in a factor with probability 1/2, by default),
+// kept only when no fewer factors give the target, i.e. its GF(2) or
+// Boolean rank is r.
+// With `unique`, Boolean targets must also have one factorization; mod-2
+// targets above one factor never do (see gf2Factorizations).
+class BmfGenerator {
+public:
+    BmfGenerator(int n, int r, Mode mode, uint64_t seed, double density = 0.5)
+        : n(n), r(r), mode(mode), density(density), rng(seed) {}
+
+    // Up to `limit` random targets until one qualifies; tried() counts them
+    bool generate(Target& target, bool unique = false, long limit = 10000);
+    long tried() const { return attempts; }
+
+private:
+    int n, r;
+    Mode mode;
+    double density;
+    std::mt19937_64 rng;
+    long attempts = 0;
+};
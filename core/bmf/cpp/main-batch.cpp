@@ -0,0 +1,87 @@
+#include "generator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+// bmfgen: generate targets whose minimal factor count is r, in parallel.
+// Each line of the output is a web/bmf/encoder.js code. Target i comes from
+// seed + i, so the output is the same for any thread count.
+int main(int argc, char* argv[]) {
+    int n = 5, r = 3;
+    Mode mode = GF2;
+    long count = 100;
+    uint64_t seed = 1;
+    bool unique = false;
+    int density = 50;   // percent of rows and columns in each factor
+    int threads = 1;   // 0: one per hardware thread
+    const char* outPath = nullptr;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) usage = (n = std::atoi(argv[++i])) < MIN_SIZE || n > MAX_SIZE;
+        else if (arg == "--factors" && i + 1 < argc) usage = (r = std::atoi(argv[++i])) < 1 || r > MAX_FACTORS;
+        else if (arg == "--mode" && i + 1 < argc) {
+            const std::string name = argv[++i];
+            mode = name == "or" ? BOOLEAN : GF2;
+            usage = name != "or" && name != "mod";
+        }
+        else if (arg == "--count" && i + 1 < argc) usage = (count = std::atol(argv[++i])) < 1;
+        else if (arg == "--unique") unique = true;
+        else if (arg == "--density" && i + 1 < argc) usage = (density = std::atoi(argv[++i])) < 1 || density > 99;
+        else if (arg == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc) usage = (threads = std::atoi(argv[++i])) < 0;
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else usage = true;
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--size 2-10] [--factors 1-6] [--mode mod|or] [--count n] [--unique] [--density percent] [--seed s] [--threads n] [--out targets.txt]\n";
+        return 1;
+    }
+    if (unique && mode == GF2 && r > 1) {
+        std::cerr << "Error: mod-2 targets of more than one factor never have a unique factorization" << std::endl;
+        return 1;
+    }
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<Target> targets(count);
+    std::vector<char> ok(count);
+    std::atomic<long> next{0}, tried{0};
+    auto work = [&] {
+        for (long i; (i = next++) < count;) {
+            BmfGenerator generator(n, r, mode, seed + i, density / 100.0);
+            ok[i] = generator.generate(targets[i], unique);
+            tried += generator.tried();
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) workers.emplace_back(work);
+    work();
+    for (auto& w : workers) w.join();
+
+    std::ofstream file;
+    if (outPath) file.open(outPath);
+    std::ostream& out = outPath ? file : std::cout;
+    long failed = 0;
+    for (long i = 0; i < count; i++) {
+        if (ok[i]) out << targets[i].encode() << '\n';
+        else failed++;
+    }
+    if (outPath && !file) {
+        std::cerr << "Error: cannot write " << outPath << std::endl;
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::ostream& report = outPath ? std::cout : std::cerr;
+    report << std::format("{} targets of {}x{} with {} {} factors, {} failed, {} random targets tried, {:.2f}s\n",
+                          count - failed, n, n, r, mode == GF2 ? "mod-2" : "Boolean", failed, tried.load(), seconds);
+    return 0;
+}
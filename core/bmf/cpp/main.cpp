@@ -0,0 +1,38 @@
+#include "rank.h"
+#include <iostream>
+
+// bmf: analyze one puzzle given as a web/bmf/encoder.js code
+int main(int argc, char* argv[]) {
+    Target target;
+    if (argc != 2 || !Target::decode(argv[1], target)) {
+        std::cerr << "Usage: " << argv[0] << " <bmf code, e.g. 5314710828>\n";
+        return 1;
+    }
+    const Matrix& m = target.m;
+    std::cout << draw(m) << '\n'
+              << "Mode: " << (target.mode == GF2 ? "mod 2" : "Boolean") << ", " << target.r << " factors\n";
+
+    int rank;
+    if (target.mode == GF2) {
+        rank = gf2Rank(m);
+        const Factors factors = gf2Factors(m);
+        if (factors.product(m.n, GF2) != m) {
+            std::cerr << "Error: GF(2) factors do not reproduce the target" << std::endl;
+            return 1;
+        }
+        std::cout << "GF(2) rank: " << rank << '\n'
+                  << draw(factors, m.n)
+                  << "Factorizations: " << gf2Factorizations(rank) << '\n';
+    } else {
+        BooleanRank boolean(m);
+        rank = boolean.rank();
+        const bool unique = boolean.unique();
+        std::cout << "Boolean rank: " << rank << '\n'
+                  << draw(boolean.factors(), m.n)
+                  << "Factorizations: " << (unique ? "1" : "2 or more") << '\n'
+                  << "Branch points: " << boolean.nodes() << '\n';
+    }
+    if (rank != target.r)
+        std::cout << (rank < target.r ? "Solvable with fewer factors\n" : "Not solvable with the given factors\n");
+    return rank == target.r ? 0 : 2;
+}
@@ -0,0 +1,85 @@
+#include "matrix.h"
+#include <bit>
+
+int Matrix::ones() const {
+    int k = 0;
+    for (int i = 0; i < n; i++) k += std::popcount(rows[i]);
+    return k;
+}
+
+Matrix Factors::product(int n, Mode mode) const {
+    Matrix m;
+    m.n = n;
+    for (int k = 0; k < size(); k++) {
+        for (int i = 0; i < n; i++) {
+            if (!(u[k] >> i & 1)) continue;
+            if (mode == BOOLEAN) m.rows[i] |= v[k];
+            else m.rows[i] ^= v[k];
+        }
+    }
+    return m;
+}
+
+std::string Target::encode() const {
+    static const char hex[] = "0123456789ABCDEF";
+    std::vector<int> bits;
+    for (int field : {m.n, r, mode == GF2 ? 1 : 0})
+        for (int b = 3; b >= 0; b--) bits.push_back(field >> b & 1);
+    for (int i = 0; i < m.n; i++)
+        for (int j = 0; j < m.n; j++) bits.push_back(m.get(i, j));
+    bits.resize((bits.size() + 3) / 4 * 4);
+
+    std::string code;
+    for (size_t i = 0; i < bits.size(); i += 4) code += hex[bits[i] << 3 | bits[i + 1] << 2 | bits[i + 2] << 1 | bits[i + 3]];
+    return code;
+}
+
+bool Target::decode(const std::string& code, Target& target) {
+    std::vector<int> bits;
+    for (char ch : code) {
+        int d;
+        if (ch >= '0' && ch <= '9') d = ch - '0';
+        else if (ch >= 'A' && ch <= 'F') d = ch - 'A' + 10;
+        else if (ch >= 'a' && ch <= 'f') d = ch - 'a' + 10;
+        else return false;
+        for (int b = 3; b >= 0; b--) bits.push_back(d >> b & 1);
+    }
+    if (bits.size() < 12) return false;
+    auto field = [&](int at) { return bits[at] << 3 | bits[at + 1] << 2 | bits[at + 2] << 1 | bits[at + 3]; };
+
+    target = Target();
+    const int n = field(0), modeBit = field(8);
+    target.r = field(4);
+    if (n < MIN_SIZE || n > MAX_SIZE || target.r < 1 || target.r > MAX_FACTORS || modeBit > 1) return false;
+    target.mode = modeBit ? GF2 : BOOLEAN;
+    target.m.n = n;
+    // Missing cells are zeros, as in the web client
+    for (int i = 0; i < n; i++)
+        for (int j = 0; j < n; j++)
+            if (size_t at = 12 + i * n + j; at < bits.size() && bits[at]) target.m.set(i, j);
+    return true;
+}
+
+std::string draw(const Matrix& m) {
+    std::string out;
+    for (int i = 0; i < m.n; i++) {
+        for (int j = 0; j < m.n; j++) {
+            if (j) out += ' ';
+            out += m.get(i, j) ? '#' : '.';
+        }
+        out += '\n';
+    }
+    return out;
+}
+
+std::string draw(const Factors& factors, int n) {
+    auto mask = [n](Row bits) {
+        std::string s;
+        for (int i = 0; i < n; i++) s += bits >> i & 1 ? '1' : '0';
+        return s;
+    };
+    std::string out;
+    for (int k = 0; k < factors.size(); k++)
+        out += "rows " + mask(factors.u[k]) + "  columns " + mask(factors.v[k]) + '\n';
+    return out;
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Boolean matrix factorization puzzles: an n x n target of 0/1 cells is to
+// be written as r rank-1 products (a set of rows times a set of columns),
+// combined with OR (Boolean mode) or with XOR (mod-2 mode, GF(2)).
+//
+// Rows are bit-packed: bit j of rows[i] is cell (i, j), so a rank-1 product
+// is the column mask written into every row of its row mask.
+constexpr int MIN_SIZE = 2;
+constexpr int MAX_SIZE = 10;    // the limits of web/bmf codes
+constexpr int MAX_FACTORS = 6;
+constexpr int MAX_ROWS = 16;    // what a Row holds
+using Row = uint16_t;
+
+enum Mode : uint8_t { BOOLEAN, GF2 };
+
+struct Matrix {
+    int n = 0;
+    std::array<Row, MAX_ROWS> rows{};
+
+    bool get(int i, int j) const { return rows[i] >> j & 1; }
+    void set(int i, int j) { rows[i] |= Row(1 << j); }
+    int ones() const;
+    bool operator==(const Matrix& other) const = default;
+};
+
+// Factor k is the product of row mask u[k] and column mask v[k]
+struct Factors {
+    std::vector<Row> u, v;
+
+    int size() const { return int(u.size()); }
+    Matrix product(int n, Mode mode) const;
+};
+
+struct Target {
+    Matrix m;
+    int r = 0;
+    Mode mode = GF2;
+
+    // Codes of web/bmf/encoder.js: n, r and the mode (1 mod-2, 0 Boolean)
+    // as one hex digit each, then the cells in row order, 4 bits per digit
+    std::string encode() const;
+    static bool decode(const std::string& code, Target& target);
+};
+
+// Text drawing, # for ones
+std::string draw(const Matrix& m);
+std::string draw(const Factors& factors, int n);
@@ -0,0 +1,199 @@
+#include "rank.h"
+#include <algorithm>
+#include <bit>
+
+namespace {
+
+// Reduced row-echelon basis of the rows, with each basis row's pivot bit
+void reduce(const Matrix& m, std::vector<Row>& basis, std::vector<Row>& pivots) {
+    for (int i = 0; i < m.n; i++) {
+        Row row = m.rows[i];
+        for (size_t k = 0; k < basis.size(); k++)
+            if (row & pivots[k]) row ^= basis[k];
+        if (!row) continue;
+        const Row pivot = Row(row & -row);
+        for (size_t k = 0; k < basis.size(); k++)
+            if (basis[k] & pivot) basis[k] ^= row;
+        basis.push_back(row);
+        pivots.push_back(pivot);
+    }
+}
+
+} // namespace
+
+int gf2Rank(const Matrix& m) {
+    std::vector<Row> basis, pivots;
+    reduce(m, basis, pivots);
+    return int(basis.size());
+}
+
+Factors gf2Factors(const Matrix& m) {
+    std::vector<Row> basis, pivots;
+    reduce(m, basis, pivots);
+    Factors factors;
+    for (size_t k = 0; k < basis.size(); k++) {
+        Row u = 0;
+        for (int i = 0; i < m.n; i++)
+            if (m.rows[i] & pivots[k]) u |= Row(1 << i);
+        factors.u.push_back(u);
+        factors.v.push_back(basis[k]);
+    }
+    return factors;
+}
+
+long gf2Factorizations(int rank) {
+    long count = 1;
+    for (int i = 0; i < rank; i++) count *= (1L << rank) - (1L << i);
+    for (int i = 2; i <= rank; i++) count /= i;
+    return count;
+}
+
+BooleanRank::BooleanRank(const Matrix& m) : m(m) {
+    // Column sets of maximal rectangles are the intersections of rows
+    std::vector<Row> closed;
+    for (int i = 0; i < m.n; i++) {
+        if (!m.rows[i]) continue;
+        std::vector<Row> next = closed;
+        next.push_back(m.rows[i]);
+        for (Row c : closed)
+            if (c & m.rows[i]) next.push_back(c & m.rows[i]);
+        std::sort(next.begin(), next.end());
+        next.erase(std::unique(next.begin(), next.end()), next.end());
+        closed = std::move(next);
+    }
+    for (Row cols : closed) {
+        Rect rect{0, cols};
+        for (int i = 0; i < m.n; i++)
+            if ((m.rows[i] & cols) == cols) rect.rows |= Row(1 << i);
+        for (int i = 0; i < m.n; i++) {
+            if (!(rect.rows >> i & 1)) continue;
+            for (int j = 0; j < m.n; j++)
+                if (cols >> j & 1) through[i * MAX_ROWS + j].push_back(int(rects.size()));
+        }
+        rects.push_back(rect);
+    }
+}
+
+// Greedy fooling set: ones (i, j) and (k, l) share no rectangle when
+// (i, l) or (k, j) is a zero
+int BooleanRank::lowerBound(const Cells& uncovered) const {
+    int fooling[MAX_ROWS * MAX_ROWS][2], size = 0;
+    for (int i = 0; i < m.n; i++) {
+        for (Row bits = uncovered[i]; bits; bits &= bits - 1) {
+            const int j = std::countr_zero(bits);
+            bool apart = true;
+            for (int f = 0; f < size && apart; f++)
+                apart = !m.get(i, fooling[f][1]) || !m.get(fooling[f][0], j);
+            if (apart) {
+                fooling[size][0] = i;
+                fooling[size][1] = j;
+                size++;
+            }
+        }
+    }
+    return size;
+}
+
+bool BooleanRank::search(const Cells& uncovered, int limit) {
+    int cell = -1;
+    size_t fewest = SIZE_MAX;
+    for (int i = 0; i < m.n; i++) {
+        for (Row bits = uncovered[i]; bits; bits &= bits - 1) {
+            const int c = i * MAX_ROWS + std::countr_zero(bits);
+            if (through[c].size() < fewest) {
+                cell = c;
+                fewest = through[c].size();
+            }
+        }
+    }
+    if (cell < 0) {
+        if (covers) {
+            std::vector<int> cover = chosen;
+            std::sort(cover.begin(), cover.end());
+            covers->insert(cover);
+            return covers->size() >= cap;
+        }
+        best = Factors();
+        for (int k : chosen) {
+            best.u.push_back(rects[k].rows);
+            best.v.push_back(rects[k].cols);
+        }
+        return true;
+    }
+    if (int(chosen.size()) + lowerBound(uncovered) > limit) return false;
+
+    // New cells of each candidate, as a mask per row
+    const std::vector<int>& candidates = through[cell];
+    std::vector<Cells> gains(candidates.size());
+    for (size_t k = 0; k < candidates.size(); k++) {
+        const Rect& rect = rects[candidates[k]];
+        for (int i = 0; i < m.n; i++) gains[k][i] = rect.rows >> i & 1 ? Row(uncovered[i] & rect.cols) : 0;
+    }
+    auto within = [&](size_t a, size_t b) {
+        for (int i = 0; i < m.n; i++)
+            if (gains[a][i] & ~gains[b][i]) return false;
+        return true;
+    };
+
+    for (size_t k = 0; k < candidates.size(); k++) {
+        // Counting needs every cover, so only prune when looking for one
+        bool dominated = false;
+        for (size_t o = 0; o < candidates.size() && !covers && !dominated; o++)
+            dominated = o != k && within(k, o) && (!within(o, k) || o < k);
+        if (dominated) continue;
+
+        branches++;
+        Cells next = uncovered;
+        for (int i = 0; i < m.n; i++) next[i] &= Row(~gains[k][i]);
+        chosen.push_back(candidates[k]);
+        const bool done = search(next, limit);
+        chosen.pop_back();
+        if (done) return true;
+    }
+    return false;
+}
+
+int BooleanRank::rank(int limit) {
+    Cells all{};
+    std::copy(m.rows.begin(), m.rows.end(), all.begin());
+    found = -1;
+    best = Factors();
+    for (int k = lowerBound(all); k <= limit; k++) {
+        if (search(all, k)) {
+            found = k;
+            break;
+        }
+    }
+    return found;
+}
+
+bool BooleanRank::unique() {
+    if (found < 0) return false;
+    std::set<std::vector<int>> distinct;
+    covers = &distinct;
+    cap = 2;
+    Cells all{};
+    std::copy(m.rows.begin(), m.rows.end(), all.begin());
+    search(all, found);
+    covers = nullptr;
+    if (distinct.size() != 1) return false;
+
+    // A row or column of a rectangle that the others cover could be dropped
+    const std::vector<int>& cover = *distinct.begin();
+    for (int k : cover) {
+        Cells others{};
+        for (int o : cover) {
+            if (o == k) continue;
+            for (int i = 0; i < m.n; i++)
+                if (rects[o].rows >> i & 1) others[i] |= rects[o].cols;
+        }
+        Row shared = rects[k].cols;
+        for (int i = 0; i < m.n; i++) {
+            if (!(rects[k].rows >> i & 1)) continue;
+            if (!(rects[k].cols & ~others[i])) return false;
+            shared &= others[i];
+        }
+        if (shared) return false;
+    }
+    return true;
+}
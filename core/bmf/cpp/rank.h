@@ -0,0 +1,61 @@
+#pragma once
+#include "matrix.h"
+#include <set>
+
+// Rank over GF(2), by Gaussian elimination on the packed rows
+int gf2Rank(const Matrix& m);
+
+// A factorization into gf2Rank(m) products: the rows of the reduced
+// row-echelon basis are the column masks, and each matrix row XORs in the
+// basis rows whose pivot column it holds
+Factors gf2Factors(const Matrix& m);
+
+// Unordered sets of `rank` products XORing to a matrix of that rank: the
+// change-of-basis matrices |GL(rank, 2)| over the rank! orders. Above rank
+// 1 the mod-2 factorization is never unique.
+long gf2Factorizations(int rank);
+
+// Boolean rank: the fewest rectangles of ones whose union is the matrix.
+// Some minimal cover only uses maximal rectangles, so the search branches
+// over the maximal rectangles through the uncovered cell that has the
+// fewest of them, skipping rectangles whose new cells another candidate
+// also covers. A fooling set (ones no two of which fit in one rectangle)
+// of the uncovered cells bounds the rectangles still needed.
+class BooleanRank {
+public:
+    explicit BooleanRank(const Matrix& m);
+
+    // The Boolean rank, or -1 when it is above limit; factors() then holds
+    // a minimal cover
+    int rank(int limit = MAX_ROWS);
+    const Factors& factors() const { return best; }
+
+    // After rank(): whether exactly one set of that many products ORs to
+    // the matrix. That holds when one cover of maximal rectangles exists
+    // and none of its rectangles can lose a row or column to the others.
+    bool unique();
+
+    // Branch points of the searches so far
+    long nodes() const { return branches; }
+
+private:
+    struct Rect {
+        Row rows, cols;
+    };
+    using Cells = std::array<Row, MAX_ROWS>;
+
+    int lowerBound(const Cells& uncovered) const;
+    bool search(const Cells& uncovered, int limit);
+
+    Matrix m;
+    std::vector<Rect> rects;                  // every maximal rectangle
+    std::array<std::vector<int>, MAX_ROWS * MAX_ROWS> through;   // rectangles through cell (i, j)
+    std::vector<int> chosen;
+    Factors best;
+    int found = -1;
+    long branches = 0;
+
+    // While counting covers: the distinct ones found, up to a cap
+    std::set<std::vector<int>>* covers = nullptr;
+    size_t cap = 0;
+};
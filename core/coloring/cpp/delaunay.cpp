@@ -0,0 +1,246 @@
+#include "delaunay.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+
+double distance2(double ax, double ay, double bx, double by) {
+    return (ax - bx) * (ax - bx) + (ay - by) * (ay - by);
+}
+
+// Whether r is strictly right of the line from p to q
+bool orient(double px, double py, double qx, double qy, double rx, double ry) {
+    return (qy - py) * (rx - qx) - (qx - px) * (ry - qy) < 0;
+}
+
+bool inCircle(double ax, double ay, double bx, double by, double cx, double cy, double px, double py) {
+    const double dx = ax - px, dy = ay - py, ex = bx - px, ey = by - py, fx = cx - px, fy = cy - py;
+    const double ap = dx * dx + dy * dy, bp = ex * ex + ey * ey, cp = fx * fx + fy * fy;
+    return dx * (ey * cp - bp * fy) - dy * (ex * cp - bp * fx) + ap * (ex * fy - ey * fx) < 0;
+}
+
+// Circumcenter offset from a; its squared length is the circumradius squared
+void circumOffset(double ax, double ay, double bx, double by, double cx, double cy, double& x, double& y) {
+    const double dx = bx - ax, dy = by - ay, ex = cx - ax, ey = cy - ay;
+    const double bl = dx * dx + dy * dy, cl = ex * ex + ey * ey;
+    const double d = 0.5 / (dx * ey - dy * ex);
+    x = (ey * bl - dy * cl) * d;
+    y = (dx * cl - ex * bl) * d;
+}
+
+// Monotone in the angle of (dx, dy), in [0, 1)
+double pseudoAngle(double dx, double dy) {
+    const double p = dx / (std::abs(dx) + std::abs(dy));
+    return (dy > 0 ? 3 - p : 1 + p) / 4;
+}
+
+} // namespace
+
+Delaunay::Delaunay(const std::vector<double>& coords) : coords(coords) {
+    const int n = int(coords.size() / 2);
+    if (n < 3) return;
+    auto X = [&](int i) { return coords[2 * i]; };
+    auto Y = [&](int i) { return coords[2 * i + 1]; };
+
+    double minX = X(0), minY = Y(0), maxX = X(0), maxY = Y(0);
+    for (int i = 1; i < n; i++) {
+        minX = std::min(minX, X(i));
+        minY = std::min(minY, Y(i));
+        maxX = std::max(maxX, X(i));
+        maxY = std::max(maxY, Y(i));
+    }
+
+    // Seed triangle: the point nearest the center, its nearest neighbor,
+    // and the point making the smallest circumcircle with them
+    const double midX = (minX + maxX) / 2, midY = (minY + maxY) / 2;
+    constexpr double inf = std::numeric_limits<double>::infinity();
+    int i0 = 0, i1 = -1, i2 = -1;
+    double best = inf;
+    for (int i = 0; i < n; i++) {
+        const double d = distance2(midX, midY, X(i), Y(i));
+        if (d < best) {
+            i0 = i;
+            best = d;
+        }
+    }
+    best = inf;
+    for (int i = 0; i < n; i++) {
+        const double d = distance2(X(i0), Y(i0), X(i), Y(i));
+        if (i != i0 && d > 0 && d < best) {
+            i1 = i;
+            best = d;
+        }
+    }
+    if (i1 < 0) return;
+    best = inf;
+    for (int i = 0; i < n; i++) {
+        if (i == i0 || i == i1) continue;
+        double x, y;
+        circumOffset(X(i0), Y(i0), X(i1), Y(i1), X(i), Y(i), x, y);
+        const double r = x * x + y * y;
+        if (r < best) {
+            i2 = i;
+            best = r;
+        }
+    }
+    if (i2 < 0 || best == inf) return;   // collinear
+    if (orient(X(i0), Y(i0), X(i1), Y(i1), X(i2), Y(i2))) std::swap(i1, i2);
+
+    double ox, oy;
+    circumOffset(X(i0), Y(i0), X(i1), Y(i1), X(i2), Y(i2), ox, oy);
+    cx = X(i0) + ox;
+    cy = Y(i0) + oy;
+
+    std::vector<double> dists(n);
+    for (int i = 0; i < n; i++) dists[i] = distance2(X(i), Y(i), cx, cy);
+    std::vector<int> ids(n);
+    std::iota(ids.begin(), ids.end(), 0);
+    std::sort(ids.begin(), ids.end(), [&](int a, int b) { return dists[a] != dists[b] ? dists[a] < dists[b] : a < b; });
+
+    const int maxTriangles = std::max(2 * n - 5, 0);
+    triangles.reserve(maxTriangles * 3);
+    halfedges.reserve(maxTriangles * 3);
+    hullPrev.assign(n, 0);
+    hullNext.assign(n, 0);
+    hullTri.assign(n, 0);
+    hullHash.assign(int(std::ceil(std::sqrt(n))), -1);
+
+    hullStart = i0;
+    hullNext[i0] = hullPrev[i2] = i1;
+    hullNext[i1] = hullPrev[i0] = i2;
+    hullNext[i2] = hullPrev[i1] = i0;
+    hullTri[i0] = 0;
+    hullTri[i1] = 1;
+    hullTri[i2] = 2;
+    for (int i : {i0, i1, i2}) hullHash[hashKey(X(i), Y(i))] = i;
+    addTriangle(i0, i1, i2, -1, -1, -1);
+
+    const int hashSize = int(hullHash.size());
+    double xp = 0, yp = 0;
+    for (int k = 0; k < n; k++) {
+        const int i = ids[k];
+        const double x = X(i), y = Y(i);
+        if (k > 0 && x == xp && y == yp) continue;   // duplicate
+        xp = x;
+        yp = y;
+        if (i == i0 || i == i1 || i == i2) continue;
+
+        // A hull vertex near the point's angle, then the first hull edge
+        // the point sees from there
+        int start = 0;
+        const int key = hashKey(x, y);
+        for (int j = 0; j < hashSize; j++) {
+            start = hullHash[(key + j) % hashSize];
+            if (start != -1 && start != hullNext[start]) break;
+        }
+        start = hullPrev[start];
+        int e = start, q;
+        while (q = hullNext[e], !orient(x, y, X(e), Y(e), X(q), Y(q))) {
+            e = q;
+            if (e == start) {
+                e = -1;
+                break;
+            }
+        }
+        if (e == -1) continue;   // on the hull already
+
+        int t = addTriangle(e, i, hullNext[e], -1, -1, hullTri[e]);
+        hullTri[i] = legalize(t + 2);
+        hullTri[e] = t;
+
+        // Connect the other visible edges, forward then backward
+        int next = hullNext[e];
+        while (q = hullNext[next], orient(x, y, X(next), Y(next), X(q), Y(q))) {
+            t = addTriangle(next, i, q, hullTri[i], -1, hullTri[next]);
+            hullTri[i] = legalize(t + 2);
+            hullNext[next] = next;   // off the hull
+            next = q;
+        }
+        if (e == start) {
+            while (q = hullPrev[e], orient(x, y, X(q), Y(q), X(e), Y(e))) {
+                t = addTriangle(q, i, e, -1, hullTri[e], hullTri[q]);
+                legalize(t + 2);
+                hullTri[q] = t;
+                hullNext[e] = e;
+                e = q;
+            }
+        }
+
+        hullStart = hullPrev[i] = e;
+        hullNext[e] = hullPrev[next] = i;
+        hullNext[i] = next;
+        hullHash[hashKey(x, y)] = i;
+        hullHash[hashKey(X(e), Y(e))] = e;
+    }
+}
+
+int Delaunay::hashKey(double x, double y) const {
+    const int size = int(hullHash.size());
+    return int(std::floor(pseudoAngle(x - cx, y - cy) * size)) % size;
+}
+
+void Delaunay::link(int a, int b) {
+    halfedges[a] = b;
+    if (b != -1) halfedges[b] = a;
+}
+
+int Delaunay::addTriangle(int i0, int i1, int i2, int a, int b, int c) {
+    const int t = int(triangles.size());
+    triangles.insert(triangles.end(), {i0, i1, i2});
+    halfedges.insert(halfedges.end(), {-1, -1, -1});
+    link(t, a);
+    link(t + 1, b);
+    link(t + 2, c);
+    return t;
+}
+
+// Flip the edge at half-edge a while its opposite point lies inside the
+// circumcircle, then check the two edges the flip exposed
+int Delaunay::legalize(int a) {
+    int ar = 0;
+    for (;;) {
+        const int b = halfedges[a];
+        const int a0 = a - a % 3;
+        ar = a0 + (a + 2) % 3;
+        if (b == -1) {
+            if (edgeStack.empty()) break;
+            a = edgeStack.back();
+            edgeStack.pop_back();
+            continue;
+        }
+
+        const int b0 = b - b % 3;
+        const int al = a0 + (a + 1) % 3, bl = b0 + (b + 2) % 3;
+        const int p0 = triangles[ar], pr = triangles[a], pl = triangles[al], p1 = triangles[bl];
+        const bool illegal = inCircle(coords[2 * p0], coords[2 * p0 + 1], coords[2 * pr], coords[2 * pr + 1],
+                                      coords[2 * pl], coords[2 * pl + 1], coords[2 * p1], coords[2 * p1 + 1]);
+        if (!illegal) {
+            if (edgeStack.empty()) break;
+            a = edgeStack.back();
+            edgeStack.pop_back();
+            continue;
+        }
+
+        triangles[a] = p1;
+        triangles[b] = p0;
+        const int hbl = halfedges[bl];
+        if (hbl == -1) {
+            // The flipped edge was on the hull: repoint the hull's triangle
+            int e = hullStart;
+            do {
+                if (hullTri[e] == bl) {
+                    hullTri[e] = a;
+                    break;
+                }
+                e = hullPrev[e];
+            } while (e != hullStart);
+        }
+        link(a, hbl);
+        link(b, halfedges[ar]);
+        link(ar, bl);
+        edgeStack.push_back(b0 + (b + 1) % 3);
+    }
+    return ar;
+}
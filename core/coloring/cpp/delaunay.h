@@ -0,0 +1,32 @@
+#pragma once
+#include <vector>
+
+// Delaunay triangulation by sweep-hull, after the Delaunator library that
+// web/coloring/planar.js simplifies: points are added in order of distance
+// from a seed triangle's circumcenter, each one connected to the hull
+// edges it sees, and new triangles are flipped until every edge is
+// locally Delaunay. A hash of hull vertices by angle finds a visible edge
+// in near-constant time, so the whole run is O(n log n) for the sort.
+//
+// Integer coordinates keep every predicate exact. Duplicate points are
+// skipped; with fewer than 3 points or all points collinear there are no
+// triangles.
+class Delaunay {
+public:
+    explicit Delaunay(const std::vector<double>& coords);   // x0, y0, x1, y1, ...
+
+    std::vector<int> triangles;   // three point indices per triangle, all of one orientation
+    std::vector<int> halfedges;   // opposite half-edge of each triangle side, -1 on the hull
+
+private:
+    int addTriangle(int i0, int i1, int i2, int a, int b, int c);
+    void link(int a, int b);
+    int legalize(int a);
+    int hashKey(double x, double y) const;
+
+    const std::vector<double>& coords;
+    std::vector<int> hullPrev, hullNext, hullTri, hullHash;
+    std::vector<int> edgeStack;
+    int hullStart = 0;
+    double cx = 0, cy = 0;
+};
@@ -0,0 +1,141 @@
+#include "generator.h"
+#include "delaunay.h"
+#include "solver.h"
+#include <algorithm>
+#include <cmath>
+#include <set>
+
+Graph ColoringGenerator::planarGraph() {
+    std::uniform_real_distribution<double> unit;
+    std::vector<double> coords(2 * n);
+    for (double& c : coords) c = unit(rng);
+
+    for (int iteration = 0; iteration < relax; iteration++) {
+        const Delaunay delaunay(coords);
+        const std::vector<int>& t = delaunay.triangles;
+
+        // Voronoi vertices around each point are the circumcenters of its
+        // triangles; points on the hull have unbounded cells and stay put
+        std::vector<std::vector<std::pair<double, double>>> cells(n);
+        std::vector<char> hull(n);
+        for (size_t h = 0; h < t.size(); h++)
+            if (delaunay.halfedges[h] == -1) hull[t[h]] = hull[t[h - h % 3 + (h + 1) % 3]] = 1;
+        for (size_t k = 0; k < t.size(); k += 3) {
+            const double ax = coords[2 * t[k]], ay = coords[2 * t[k] + 1];
+            const double dx = coords[2 * t[k + 1]] - ax, dy = coords[2 * t[k + 1] + 1] - ay;
+            const double ex = coords[2 * t[k + 2]] - ax, ey = coords[2 * t[k + 2] + 1] - ay;
+            const double bl = dx * dx + dy * dy, cl = ex * ex + ey * ey, d = 0.5 / (dx * ey - dy * ex);
+            const std::pair<double, double> center{ax + (ey * bl - dy * cl) * d, ay + (dx * cl - ex * bl) * d};
+            for (int i = 0; i < 3; i++) cells[t[k + i]].push_back(center);
+        }
+        std::vector<double> next = coords;
+        for (int i = 0; i < n; i++) {
+            auto& cell = cells[i];
+            if (hull[i] || cell.size() < 3) continue;
+            const double px = coords[2 * i], py = coords[2 * i + 1];
+            std::sort(cell.begin(), cell.end(), [&](auto& a, auto& b) {
+                return std::atan2(a.second - py, a.first - px) < std::atan2(b.second - py, b.first - px);
+            });
+            double area = 0, cx = 0, cy = 0;
+            for (size_t j = 0; j < cell.size(); j++) {
+                const auto& [x0, y0] = cell[j];
+                const auto& [x1, y1] = cell[(j + 1) % cell.size()];
+                const double v = x0 * y1 - x1 * y0;
+                area += v;
+                cx += (x0 + x1) * v;
+                cy += (y0 + y1) * v;
+            }
+            if (area <= 0) continue;
+            next[2 * i] = std::clamp(cx / (3 * area), 0.0, 1.0);
+            next[2 * i + 1] = std::clamp(cy / (3 * area), 0.0, 1.0);
+        }
+        coords = std::move(next);
+    }
+
+    // Snap to the grid, moving to the nearest free spot on collisions
+    Graph graph;
+    std::set<std::pair<int, int>> taken;
+    for (int i = 0; i < n; i++) {
+        const int x = int(std::lround(coords[2 * i] * 100)), y = int(std::lround(coords[2 * i + 1] * 100));
+        int gx = x, gy = y;
+        for (int ring = 1; taken.count({gx, gy}); ring++) {
+            for (int dy = -ring; dy <= ring && taken.count({gx, gy}); dy++) {
+                for (int dx = -ring; dx <= ring; dx++) {
+                    const int cx = std::clamp(x + dx, 0, 100), cy = std::clamp(y + dy, 0, 100);
+                    if (!taken.count({cx, cy})) {
+                        gx = cx;
+                        gy = cy;
+                        break;
+                    }
+                }
+            }
+        }
+        taken.insert({gx, gy});
+        graph.addVertex(gx, gy);
+        coords[2 * i] = gx;
+        coords[2 * i + 1] = gy;
+    }
+
+    const Delaunay delaunay(coords);
+    for (size_t h = 0; h < delaunay.triangles.size(); h++)
+        graph.addEdge(delaunay.triangles[h], delaunay.triangles[h - h % 3 + (h + 1) % 3]);
+    std::sort(graph.edges.begin(), graph.edges.end());
+    return graph;
+}
+
+bool ColoringGenerator::generate(Result& result, long budget, int attempts) {
+    std::uniform_int_distribution<int> color(1, GAME_COLORS);
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        const Graph triangulation = planarGraph();
+        std::vector<uint8_t> planted(n);
+        for (auto& c : planted) c = uint8_t(color(rng));
+
+        Puzzle puzzle;
+        for (int v = 0; v < n; v++) puzzle.graph.addVertex(triangulation.x[v], triangulation.y[v]);
+        for (auto [a, b] : triangulation.edges)
+            if (planted[a] != planted[b]) puzzle.graph.addEdge(a, b);
+        if (bipartite(puzzle.graph)) continue;   // the planted coloring already bounds it by 3
+        puzzle.colors.assign(n, 0);
+
+        std::vector<uint8_t> solution;
+        if (!settle(puzzle, solution, budget)) continue;
+
+        // Drop pre-colors in random order while the coloring stays unique
+        std::vector<int> order;
+        for (int v = 0; v < n; v++)
+            if (puzzle.colors[v]) order.push_back(v);
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int v : order) {
+            const uint8_t kept = puzzle.colors[v];
+            puzzle.colors[v] = 0;
+            if (ColoringSolver(puzzle.graph, GAME_COLORS, puzzle.colors).count(2, budget) != 1) puzzle.colors[v] = kept;
+        }
+
+        ColoringSolver solver(puzzle.graph, GAME_COLORS, puzzle.colors);
+        solver.count(2);
+        result.puzzle = std::move(puzzle);
+        result.solution = solution;
+        result.nodes = solver.nodes();
+        return true;
+    }
+    return false;
+}
+
+// Pre-color vertices until one coloring fits. While two colorings fit, fix
+// a vertex where they differ to its color in the first, which becomes the
+// target. Fails when the solver gives up.
+bool ColoringGenerator::settle(Puzzle& puzzle, std::vector<uint8_t>& solution, long budget) {
+    for (;;) {
+        ColoringSolver solver(puzzle.graph, GAME_COLORS, puzzle.colors);
+        const int solutions = solver.count(2, budget);
+        if (solutions < 1) return false;
+        solution = solver.solution(0);
+        if (solutions == 1) return true;
+
+        std::vector<int> differ;
+        for (int v = 0; v < n; v++)
+            if (solution[v] != solver.solution(1)[v]) differ.push_back(v);
+        const int v = differ[std::uniform_int_distribution<size_t>(0, differ.size() - 1)(rng)];
+        puzzle.colors[v] = solution[v];
+    }
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include "graph.h"
+#include <random>
+
+// Puzzle generator. Random points are spread by Lloyd relaxation (each
+// interior point moves to the centroid of its Voronoi cell), snapped to
+// the 0-100 grid and triangulated, which gives a planar graph with
+// straight, non-crossing edges. A random 3-coloring is planted by dropping
+// the edges it breaks, and graphs that 2 colors would do are skipped.
+// Pre-colored vertices are then added until one coloring fits (see
+// settle()) and removed again while it stays the only one. Uniqueness is
+// only accepted when the solver proves it within a budget of branch points.
+class ColoringGenerator {
+public:
+    ColoringGenerator(int n, uint64_t seed, int relax = 2) : n(n), relax(relax), rng(seed) {}
+
+    struct Result {
+        Puzzle puzzle;
+        std::vector<uint8_t> solution;
+        long nodes = 0;   // solver branch points, the grade
+    };
+    // Up to `attempts` graphs until one gives a puzzle
+    bool generate(Result& result, long budget = 1000, int attempts = 20);
+
+    Graph planarGraph();
+
+private:
+    bool settle(Puzzle& puzzle, std::vector<uint8_t>& solution, long budget);
+
+    int n, relax;
+    std::mt19937_64 rng;
+};
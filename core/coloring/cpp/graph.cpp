@@ -0,0 +1,79 @@
+#include "graph.h"
+#include <algorithm>
+#include <cctype>
+
+void Graph::addVertex(int vx, int vy) {
+    x.push_back(vx);
+    y.push_back(vy);
+    adjacent.emplace_back();
+    n++;
+}
+
+bool Graph::addEdge(int a, int b) {
+    if (a == b || adjacent[a][b]) return false;
+    adjacent[a][b] = adjacent[b][a] = 1;
+    edges.emplace_back(std::min(a, b), std::max(a, b));
+    return true;
+}
+
+std::string Puzzle::format() const {
+    auto list = [](const std::vector<int>& values) {
+        std::string s = "[";
+        for (size_t i = 0; i < values.size(); i++) s += (i ? ", " : "") + std::to_string(values[i]);
+        return s + "]";
+    };
+    std::vector<int> starts, ends, fixed, fixedColors;
+    for (auto [a, b] : graph.edges) {
+        starts.push_back(a);
+        ends.push_back(b);
+    }
+    for (int v = 0; v < graph.n; v++) {
+        if (!colors[v]) continue;
+        fixed.push_back(v);
+        fixedColors.push_back(colors[v]);
+    }
+    return "[" + std::to_string(graph.n) + ", " + list(graph.x) + ", " + list(graph.y) + ", " + list(starts) + ", "
+         + list(ends) + ", " + list(fixed) + ", " + list(fixedColors) + "]";
+}
+
+bool Puzzle::parse(const std::string& text, Puzzle& puzzle) {
+    // Numbers in order, each tagged with the list it sits in; comments skipped
+    std::vector<std::vector<int>> lists;
+    int count = -1, depth = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        const char ch = text[i];
+        if (ch == '/' && i + 1 < text.size() && text[i + 1] == '/') {
+            while (i < text.size() && text[i] != '\n') i++;
+        } else if (ch == '[') {
+            if (++depth == 2) lists.emplace_back();
+            if (depth > 2) return false;
+        } else if (ch == ']') {
+            if (--depth == 0) break;
+        } else if (std::isdigit(static_cast<unsigned char>(ch))) {
+            int value = 0;
+            for (; i < text.size() && std::isdigit(static_cast<unsigned char>(text[i])); i++) value = value * 10 + (text[i] - '0');
+            i--;
+            if (depth == 1 && count < 0) count = value;
+            else if (depth == 2) lists.back().push_back(value);
+            else return false;
+        }
+    }
+    if (count < 1 || count > MAX_VERTICES || lists.size() < 5 || lists.size() > 7) return false;
+    lists.resize(7);
+    const auto &xs = lists[0], &ys = lists[1], &starts = lists[2], &ends = lists[3], &fixed = lists[4], &fixedColors = lists[5];
+    if (int(xs.size()) != count || int(ys.size()) != count || starts.size() != ends.size() || fixed.size() != fixedColors.size())
+        return false;
+
+    puzzle = Puzzle();
+    for (int v = 0; v < count; v++) puzzle.graph.addVertex(xs[v], ys[v]);
+    for (size_t e = 0; e < starts.size(); e++) {
+        if (starts[e] >= count || ends[e] >= count) return false;
+        puzzle.graph.addEdge(starts[e], ends[e]);
+    }
+    puzzle.colors.assign(count, 0);
+    for (size_t i = 0; i < fixed.size(); i++) {
+        if (fixed[i] >= count || fixedColors[i] < 1 || fixedColors[i] > GAME_COLORS) return false;
+        puzzle.colors[fixed[i]] = uint8_t(fixedColors[i]);
+    }
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Graphs of the coloring game: vertices at integer positions in a 0-100
+// square, straight edges, and pre-colored vertices. Adjacency is one
+// bitset per vertex, so neighborhoods of a color class are single ANDs.
+constexpr int MAX_VERTICES = 256;
+constexpr int GAME_COLORS = 3;   // the palette of web/coloring
+using VertexSet = std::bitset<MAX_VERTICES>;
+
+struct Graph {
+    int n = 0;
+    std::vector<int> x, y;
+    std::vector<std::pair<int, int>> edges;
+    std::vector<VertexSet> adjacent;
+
+    void addVertex(int vx, int vy);
+    bool addEdge(int a, int b);   // false for loops and duplicates
+    int degree(int v) const { return int(adjacent[v].count()); }
+};
+
+struct Puzzle {
+    Graph graph;
+    std::vector<uint8_t> colors;   // pre-colored vertices, 1 to GAME_COLORS; 0 free
+
+    // Entries of web/coloring/list.js: [count, [x], [y], [edge starts],
+    // [edge ends], [pre-colored vertices], [their colors]]
+    std::string format() const;
+    static bool parse(const std::string& text, Puzzle& puzzle);
+};
@@ -0,0 +1,88 @@
+#include "generator.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// cgen: generate unique, minimally pre-colored puzzles in parallel, written
+// as a web/coloring/list.js file with each puzzle's grade (the solver's
+// branch points) in a comment. Puzzle i comes from seed + i, so the output
+// is the same for any thread count.
+int main(int argc, char* argv[]) {
+    int n = 50;
+    long count = 100;
+    uint64_t seed = 1;
+    long budget = 1000;
+    int relax = 2;
+    int threads = 1;   // 0: one per hardware thread
+    const char* outPath = nullptr;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--vertices" && i + 1 < argc) usage = (n = std::atoi(argv[++i])) < 4 || n > MAX_VERTICES;
+        else if (arg == "--count" && i + 1 < argc) usage = (count = std::atol(argv[++i])) < 1;
+        else if (arg == "--budget" && i + 1 < argc) usage = (budget = std::atol(argv[++i])) < 1;
+        else if (arg == "--relax" && i + 1 < argc) usage = (relax = std::atoi(argv[++i])) < 0;
+        else if (arg == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc) usage = (threads = std::atoi(argv[++i])) < 0;
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else usage = true;
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--vertices 4-" << MAX_VERTICES
+                  << "] [--count n] [--budget branch-points] [--relax iterations] [--seed s] [--threads n] [--out list.js]\n";
+        return 1;
+    }
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<ColoringGenerator::Result> results(count);
+    std::vector<char> ok(count);
+    std::atomic<long> next{0};
+    auto work = [&] {
+        for (long i; (i = next++) < count;) {
+            ColoringGenerator generator(n, seed + i, relax);
+            ok[i] = generator.generate(results[i], budget);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) workers.emplace_back(work);
+    work();
+    for (auto& w : workers) w.join();
+
+    std::ofstream file;
+    if (outPath) file.open(outPath);
+    std::ostream& out = outPath ? file : std::cout;
+    std::map<long, long> grades;
+    long fixed = 0, failed = 0;
+    out << "const puzzle_list = [\n";
+    for (long i = 0; i < count; i++) {
+        if (!ok[i]) {
+            failed++;
+            continue;
+        }
+        out << '\t' << results[i].puzzle.format() << ", // branch points " << results[i].nodes << '\n';
+        grades[results[i].nodes]++;
+        for (uint8_t c : results[i].puzzle.colors) fixed += c != 0;
+    }
+    out << "];\n";
+    if (outPath && !file) {
+        std::cerr << "Error: cannot write " << outPath << std::endl;
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::ostream& report = outPath ? std::cout : std::cerr;
+    report << std::format("{} puzzles of {} vertices, {} failed, {:.1f} pre-colored on average, {:.2f}s\n", count - failed, n,
+                          failed, count > failed ? double(fixed) / (count - failed) : 0.0, seconds);
+    report << "Branch points:\n";
+    for (auto [nodes, puzzles] : grades) report << std::format("    {:>6} {:>8}\n", nodes, puzzles);
+    return 0;
+}
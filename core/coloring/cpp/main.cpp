@@ -0,0 +1,63 @@
+#include "solver.h"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Branch points per color count before the chromatic number is given up
+constexpr long CHROMATIC_BUDGET = 100000;
+
+// csolver: check one puzzle of a web/coloring/list.js style file, by its
+// number as the game shows it (#1 is the first)
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argc > 3) {
+        std::cerr << "Usage: " << argv[0] << " <list.js or puzzle file> [puzzle number]\n";
+        return 1;
+    }
+    std::ifstream file(argv[1]);
+    if (!file) {
+        std::cerr << "Error: cannot read " << argv[1] << std::endl;
+        return 1;
+    }
+    std::stringstream buffer;
+    buffer << file.rdbuf();
+    std::string text = buffer.str();
+    const int number = argc == 3 ? std::atoi(argv[2]) : 1;
+
+    // In a list, skip to the requested entry of the outer array
+    if (const size_t list = text.find("puzzle_list"); list != std::string::npos) {
+        int depth = 0, entry = 0;
+        size_t i = text.find('[', list);
+        for (; i < text.size(); i++) {
+            if (text[i] == '/' && i + 1 < text.size() && text[i + 1] == '/') i = text.find('\n', i);
+            if (i == std::string::npos) break;
+            if (text[i] == '[' && ++depth == 2 && ++entry == number) break;
+            if (text[i] == ']') depth--;
+        }
+        text = i < text.size() ? text.substr(i) : "";
+    }
+
+    Puzzle puzzle;
+    if (!Puzzle::parse(text, puzzle)) {
+        std::cerr << "Error: no puzzle " << number << " in " << argv[1] << std::endl;
+        return 1;
+    }
+    const Graph& graph = puzzle.graph;
+    int fixed = 0;
+    for (uint8_t c : puzzle.colors) fixed += c != 0;
+
+    ColoringSolver solver(graph, GAME_COLORS, puzzle.colors);
+    const int solutions = solver.count(2);
+    const int chromatic = chromaticNumber(graph, nullptr, CHROMATIC_BUDGET);
+    std::cout << "Vertices: " << graph.n << ", edges: " << graph.edges.size() << ", pre-colored: " << fixed << '\n'
+              << "Chromatic number: " << (chromatic < 0 ? "unknown" : std::to_string(chromatic)) << '\n'
+              << "Solutions: " << (solutions > 1 ? "2 or more" : std::to_string(solutions)) << '\n'
+              << "Branch points: " << solver.nodes() << '\n';
+    if (solutions) {
+        std::cout << "Coloring:";
+        for (uint8_t c : solver.solution()) std::cout << ' ' << int(c);
+        std::cout << '\n';
+    }
+    return solutions == 1 ? 0 : 2;
+}
@@ -0,0 +1,127 @@
+#include "solver.h"
+#include <algorithm>
+
+ColoringSolver::ColoringSolver(const Graph& graph, int colors, const std::vector<uint8_t>& fixed)
+    : graph(graph), colors(colors), color(graph.n), classes(colors + 1) {
+    symmetric = true;
+    for (int v = 0; v < graph.n; v++) {
+        if (v < int(fixed.size()) && fixed[v]) {
+            color[v] = fixed[v];
+            classes[fixed[v]][v] = 1;
+            symmetric = false;
+        } else {
+            uncolored[v] = 1;
+        }
+    }
+}
+
+int ColoringSolver::search(int limit) {
+    // Used colors so far; without pre-colored vertices a new color is
+    // always the lowest unused one
+    int used = 0;
+    if (symmetric)
+        for (int c = colors; c >= 1 && !used; c--)
+            if (classes[c].any()) used = c;
+    const int highest = symmetric ? std::min(colors, used + 1) : colors;
+
+    int best = -1, fewest = colors + 1, mostOpen = -1;
+    unsigned options = 0;
+    for (int v = int(uncolored._Find_first()); v < MAX_VERTICES; v = int(uncolored._Find_next(v))) {
+        unsigned free = 0;
+        int k = 0;
+        for (int c = 1; c <= highest; c++) {
+            if ((graph.adjacent[v] & classes[c]).none()) {
+                free |= 1u << c;
+                k++;
+            }
+        }
+        if (k > fewest) continue;
+        const int open = int((graph.adjacent[v] & uncolored).count());
+        if (k < fewest || open > mostOpen) {
+            best = v;
+            fewest = k;
+            mostOpen = open;
+            options = free;
+        }
+        if (k == 0) break;
+    }
+    if (best < 0) {
+        if (found < 2) kept[found] = color;
+        found++;
+        return 1;
+    }
+    if (fewest == 0) return 0;
+    if (fewest > 1) {
+        if (budget && branches >= budget) {
+            gaveUp = true;
+            return 0;
+        }
+        branches++;
+    }
+
+    int total = 0;
+    uncolored[best] = 0;
+    for (int c = 1; c <= highest && total < limit; c++) {
+        if (!(options >> c & 1)) continue;
+        color[best] = uint8_t(c);
+        classes[c][best] = 1;
+        total += search(limit - total);
+        classes[c][best] = 0;
+    }
+    color[best] = 0;
+    uncolored[best] = 1;
+    return total;
+}
+
+int ColoringSolver::count(int limit, long budget) {
+    found = 0;
+    branches = 0;
+    this->budget = budget;
+    gaveUp = false;
+    kept[0].clear();
+    kept[1].clear();
+    for (int v = 0; v < graph.n; v++)
+        for (int c = 1; c <= colors; c++)
+            if (classes[c][v] && (graph.adjacent[v] & classes[c]).any()) return 0;   // clashing pre-colors
+    const int solutions = search(limit);
+    return gaveUp && solutions < limit ? -1 : solutions;
+}
+
+bool bipartite(const Graph& graph) {
+    std::vector<std::vector<int>> neighbors(graph.n);
+    for (auto [a, b] : graph.edges) {
+        neighbors[a].push_back(b);
+        neighbors[b].push_back(a);
+    }
+    std::vector<int8_t> side(graph.n, -1);
+    std::vector<int> queue;
+    for (int start = 0; start < graph.n; start++) {
+        if (side[start] >= 0) continue;
+        side[start] = 0;
+        queue.assign(1, start);
+        for (size_t i = 0; i < queue.size(); i++) {
+            const int v = queue[i];
+            for (int w : neighbors[v]) {
+                if (side[w] == side[v]) return false;
+                if (side[w] < 0) {
+                    side[w] = int8_t(1 - side[v]);
+                    queue.push_back(w);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+int chromaticNumber(const Graph& graph, std::vector<uint8_t>* coloring, long budget) {
+    const int first = graph.edges.empty() ? 1 : bipartite(graph) ? 2 : 3;
+    for (int k = first;; k++) {
+        ColoringSolver solver(graph, k);
+        const int found = solver.count(1, budget);
+        if (found < 0) return -1;
+        if (found) {
+            if (coloring) *coloring = solver.solution();
+            return k;
+        }
+    }
+}
@@ -0,0 +1,47 @@
+#pragma once
+#include "graph.h"
+
+// Graph coloring by DSATUR backtracking on bitsets. Each color class is a
+// vertex set, so the colors left to a vertex are the classes its adjacency
+// set misses. The search always colors the vertex with the fewest colors
+// left (ties: most uncolored neighbors); a vertex with one color left is
+// forced and costs no branch point, so the branch points are a measure of
+// how much guessing an instance needs.
+class ColoringSolver {
+public:
+    // Pre-colored vertices (colors 1 to k) are kept; with none, colorings
+    // that only permute colors count once
+    ColoringSolver(const Graph& graph, int colors, const std::vector<uint8_t>& fixed = {});
+
+    // Colorings up to limit; the first two found are kept for solution().
+    // With a budget, the search gives up after that many branch points and
+    // returns -1.
+    int count(int limit = 2, long budget = 0);
+    const std::vector<uint8_t>& solution(int i = 0) const { return kept[i]; }
+
+    // Branch points of the last count()
+    long nodes() const { return branches; }
+
+private:
+    int search(int limit);
+
+    const Graph& graph;
+    int colors;
+    bool symmetric;
+    std::vector<uint8_t> color;
+    std::vector<VertexSet> classes;   // vertices of each color, 0 unused
+    VertexSet uncolored;
+    std::vector<uint8_t> kept[2];
+    int found = 0;
+    long branches = 0;
+    long budget = 0;
+    bool gaveUp = false;
+};
+
+// Whether two colors suffice, by breadth-first search in linear time
+bool bipartite(const Graph& graph);
+
+// Smallest number of colors, with one such coloring. With a budget, each
+// search for k colors gives up after that many branch points and -1 is
+// returned.
+int chromaticNumber(const Graph& graph, std::vector<uint8_t>* coloring = nullptr, long budget = 0);
@@ -0,0 +1,128 @@
+#include "board.h"
+#include <algorithm>
+
+Board::Board(int n) : n(n) {
+    for (auto& e : edgeAt) e.fill(-1);
+    for (int r = 0; r <= n; r++) {
+        for (int c = 0; c <= n; c++) {
+            const int v = r * STRIDE + c;
+            vertices.push_back(v);
+            if (c < n) edgeAt[v][RIGHT] = int16_t(2 * v);
+            if (r < n) edgeAt[v][DOWN] = int16_t(2 * v + 1);
+            if (c > 0) edgeAt[v][LEFT] = int16_t(2 * (v - 1));
+            if (r > 0) edgeAt[v][UP] = int16_t(2 * (v - STRIDE) + 1);
+            if (r < n && c < n) cells[v] = 1;
+        }
+    }
+}
+
+int Puzzle::count() const {
+    return int(std::count_if(pearls.begin(), pearls.end(), [](Pearl p) { return p != NO_PEARL; }));
+}
+
+std::string Puzzle::encode() const {
+    static const char hex[] = "0123456789ABCDEF";
+    std::string code(1, hex[n]);
+    for (int v = 0; v < VERTICES; v++) {
+        if (!pearls[v]) continue;
+        code += hex[v % STRIDE];
+        code += hex[v / STRIDE];
+        code += pearls[v] == BLACK ? '1' : '0';
+    }
+    return code;
+}
+
+bool Puzzle::decode(const std::string& code, Puzzle& puzzle) {
+    auto digit = [](char ch) {
+        if (ch >= '0' && ch <= '9') return ch - '0';
+        if (ch >= 'A' && ch <= 'F') return ch - 'A' + 10;
+        if (ch >= 'a' && ch <= 'f') return ch - 'a' + 10;
+        return -1;
+    };
+    if (code.empty() || (code.size() - 1) % 3) return false;
+    puzzle = Puzzle();
+    puzzle.n = digit(code[0]);
+    if (puzzle.n < MIN_SIZE || puzzle.n > MAX_SIZE) return false;
+    for (size_t i = 1; i < code.size(); i += 3) {
+        const int c = digit(code[i]), r = digit(code[i + 1]);
+        if (c < 0 || r < 0 || c > puzzle.n || r > puzzle.n) return false;
+        if (code[i + 2] != '0' && code[i + 2] != '1') return false;
+        Pearl& p = puzzle.pearls[r * STRIDE + c];
+        if (p) return false;   // duplicate
+        p = code[i + 2] == '1' ? BLACK : WHITE;
+    }
+    return true;
+}
+
+namespace {
+
+bool on(const Board& board, const EdgeSet& loop, int v, int d) {
+    const int e = board.edge(v, d);
+    return e >= 0 && loop[e];
+}
+
+bool straight(const Board& board, const EdgeSet& loop, int v) {
+    return (on(board, loop, v, RIGHT) && on(board, loop, v, LEFT)) || (on(board, loop, v, DOWN) && on(board, loop, v, UP));
+}
+
+} // namespace
+
+bool isSolution(const Board& board, const Puzzle& puzzle, const EdgeSet& loop) {
+    int start = -1;
+    long edges = 0;
+    for (int v : board.vertices) {
+        int degree = 0;
+        for (int d = 0; d < 4; d++) degree += on(board, loop, v, d);
+        if (degree != 0 && degree != 2) return false;
+        if (degree) start = v;
+        edges += degree;
+        if (puzzle.pearls[v] && degree != 2) return false;
+    }
+    if (start < 0) return false;
+
+    // One loop: walking it from any vertex covers every edge
+    long walked = 0;
+    for (int v = start, prev = -1;;) {
+        int d = 0;
+        while (!on(board, loop, v, d) || v + dir_step[d] == prev) d++;
+        prev = v;
+        v += dir_step[d];
+        walked++;
+        if (v == start) break;
+    }
+    if (2 * walked != edges) return false;
+
+    for (int v : board.vertices) {
+        if (puzzle.pearls[v] == WHITE) {
+            // Straight through, turning next to it on at least one side
+            if (!straight(board, loop, v)) return false;
+            const int d = on(board, loop, v, RIGHT) ? RIGHT : DOWN;
+            if (straight(board, loop, v + dir_step[d]) && straight(board, loop, v - dir_step[d])) return false;
+        } else if (puzzle.pearls[v] == BLACK) {
+            // Turning, going straight on both legs
+            if (straight(board, loop, v)) return false;
+            for (int d = 0; d < 4; d++)
+                if (on(board, loop, v, d) && !on(board, loop, v + dir_step[d], d)) return false;
+        }
+    }
+    return true;
+}
+
+std::string draw(const Board& board, const Puzzle& puzzle, const EdgeSet& loop) {
+    std::string out;
+    for (int r = 0; r <= board.n; r++) {
+        for (int c = 0; c <= board.n; c++) {
+            const int v = r * STRIDE + c;
+            out += puzzle.pearls[v] == WHITE ? 'O' : puzzle.pearls[v] == BLACK ? '@' : '+';
+            if (c < board.n) out += on(board, loop, v, RIGHT) ? "---" : "   ";
+        }
+        out += '\n';
+        if (r == board.n) break;
+        for (int c = 0; c <= board.n; c++) {
+            out += on(board, loop, r * STRIDE + c, DOWN) ? '|' : ' ';
+            if (c < board.n) out += "   ";
+        }
+        out += '\n';
+    }
+    return out;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Masyu on an n x n grid of cells (3 to 15). The loop runs along grid lines
+// through the (n+1) x (n+1) vertices, and the pearls sit on vertices.
+// Vertex (r, c) is numbered r * STRIDE + c, so any board fits in a 256-bit
+// set. Each vertex owns the edge to its right (2v) and the edge below it
+// (2v + 1), so edge sets are 512-bit sets with the same layout.
+constexpr int MIN_SIZE = 3;
+constexpr int MAX_SIZE = 15;
+constexpr int STRIDE = 16;
+constexpr int VERTICES = STRIDE * STRIDE;
+constexpr int EDGES = 2 * VERTICES;
+using VertexSet = std::bitset<VERTICES>;
+using EdgeSet = std::bitset<EDGES>;
+
+enum Pearl : uint8_t { NO_PEARL, WHITE, BLACK };
+
+// Directions, in turn order so that (d + 2) % 4 is the opposite of d
+enum Dir { RIGHT, DOWN, LEFT, UP };
+constexpr int dir_step[4] = {1, STRIDE, -1, -STRIDE};
+
+struct Board {
+    int n;
+    std::vector<int> vertices;                       // vertex numbers of this board
+    std::array<std::array<int16_t, 4>, VERTICES> edgeAt;   // edge from a vertex in a direction, -1 off the board
+    VertexSet cells;                                 // cell (r, c) as bit r * STRIDE + c
+
+    explicit Board(int n);
+
+    int edge(int v, int d) const { return edgeAt[v][d]; }
+    static int from(int e) { return e / 2; }
+    static int to(int e) { return e / 2 + (e & 1 ? STRIDE : 1); }
+};
+
+struct Puzzle {
+    int n = 0;
+    std::array<Pearl, VERTICES> pearls{};
+
+    int count() const;
+
+    // Codes of web/masyu/encoder.js: the size as one hex digit, then
+    // column, row and type (0 white, 1 black) per pearl, in row order
+    std::string encode() const;
+    static bool decode(const std::string& code, Puzzle& puzzle);
+};
+
+// Whether `loop` is a single closed loop that satisfies every pearl
+bool isSolution(const Board& board, const Puzzle& puzzle, const EdgeSet& loop);
+
+// Text drawing of the loop and pearls (O white, @ black)
+std::string draw(const Board& board, const Puzzle& puzzle, const EdgeSet& loop);
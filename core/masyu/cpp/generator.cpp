@@ -0,0 +1,141 @@
+#include "generator.h"
+#include "solver.h"
+#include <algorithm>
+
+// Cells reachable from seed through cells of `within`
+VertexSet MasyuGenerator::grow(VertexSet seed, const VertexSet& within) const {
+    seed &= within;
+    for (;;) {
+        const VertexSet next = (seed | seed << 1 | seed >> 1 | seed << STRIDE | seed >> STRIDE) & within;
+        if (next == seed) return seed;
+        seed = next;
+    }
+}
+
+bool MasyuGenerator::simple(const VertexSet& region) const {
+    if (region.none()) return false;
+
+    // Region cells meeting only at a corner would give a vertex of degree 4
+    static thread_local int cornersFor = -1;
+    static thread_local VertexSet corners, border;
+    if (cornersFor != board.n) {
+        corners.reset();
+        border.reset();
+        for (int r = 0; r < board.n; r++) {
+            for (int c = 0; c < board.n; c++) {
+                if (r + 1 < board.n && c + 1 < board.n) corners[r * STRIDE + c] = 1;
+                if (r == 0 || c == 0 || r + 1 == board.n || c + 1 == board.n) border[r * STRIDE + c] = 1;
+            }
+        }
+        cornersFor = board.n;
+    }
+    const VertexSet right = region >> 1, below = region >> STRIDE, diagonal = region >> (STRIDE + 1);
+    if (((region ^ right) & ~(region ^ diagonal) & ~(right ^ below) & corners).any()) return false;
+
+    // One region without holes: both it and the outside are connected
+    VertexSet first;
+    first[region._Find_first()] = 1;
+    if (grow(first, region) != region) return false;
+    const VertexSet outside = board.cells & ~region;
+    return grow(outside & border, outside) == outside;
+}
+
+EdgeSet MasyuGenerator::boundary(const VertexSet& region) const {
+    const int n = board.n;
+    auto inside = [&](int r, int c) { return r >= 0 && c >= 0 && r < n && c < n && region[r * STRIDE + c]; };
+    EdgeSet loop;
+    for (int v : board.vertices) {
+        const int r = v / STRIDE, c = v % STRIDE;
+        if (c < n && inside(r - 1, c) != inside(r, c)) loop[board.edge(v, RIGHT)] = 1;
+        if (r < n && inside(r, c - 1) != inside(r, c)) loop[board.edge(v, DOWN)] = 1;
+    }
+    return loop;
+}
+
+EdgeSet MasyuGenerator::randomLoop() {
+    const int n = board.n;
+    std::uniform_int_distribution<int> cell(0, n * n - 1);
+    VertexSet region;
+    const int start = cell(rng);
+    region[start / n * STRIDE + start % n] = 1;
+    for (int step = 0; step < 10 * n * n; step++) {
+        const int k = cell(rng);
+        VertexSet next = region;
+        next.flip(k / n * STRIDE + k % n);
+        if (simple(next)) region = next;
+    }
+    return boundary(region);
+}
+
+// Every vertex of the loop where a pearl would be satisfied
+Puzzle MasyuGenerator::allPearls(const EdgeSet& loop) const {
+    auto on = [&](int v, int d) {
+        const int e = board.edge(v, d);
+        return e >= 0 && loop[e];
+    };
+    auto straight = [&](int v) { return (on(v, RIGHT) && on(v, LEFT)) || (on(v, DOWN) && on(v, UP)); };
+    auto turn = [&](int v) { return !straight(v) && (on(v, RIGHT) || on(v, LEFT)) && (on(v, DOWN) || on(v, UP)); };
+
+    Puzzle puzzle;
+    puzzle.n = board.n;
+    for (int v : board.vertices) {
+        if (straight(v)) {
+            const int d = on(v, RIGHT) ? RIGHT : DOWN;
+            if (turn(v + dir_step[d]) || turn(v - dir_step[d])) puzzle.pearls[v] = WHITE;
+        } else if (turn(v)) {
+            bool legs = true;
+            for (int d = 0; d < 4; d++)
+                if (on(v, d) && !on(v + dir_step[d], d)) legs = false;
+            if (legs) puzzle.pearls[v] = BLACK;
+        }
+    }
+    return puzzle;
+}
+
+bool MasyuGenerator::generate(Result& result, long budget, int attempts) {
+    for (int attempt = 0; attempt < attempts; attempt++) {
+        Puzzle puzzle = allPearls(randomLoop());
+        EdgeSet loop;
+        if (!settle(puzzle, loop, budget)) continue;
+
+        // Drop pearls in random order while the solution stays unique
+        std::vector<int> order;
+        for (int v : board.vertices)
+            if (puzzle.pearls[v]) order.push_back(v);
+        std::shuffle(order.begin(), order.end(), rng);
+        for (int v : order) {
+            const Pearl kept = puzzle.pearls[v];
+            puzzle.pearls[v] = NO_PEARL;
+            if (MasyuSolver(puzzle).count(2, budget) != 1) puzzle.pearls[v] = kept;
+        }
+
+        MasyuSolver solver(puzzle);
+        solver.count(2);
+        result.puzzle = puzzle;
+        result.loop = loop;
+        result.nodes = solver.nodes();
+        return true;
+    }
+    return false;
+}
+
+// Add pearls until the solution is unique. While two loops fit, add a pearl
+// that the first allows and the second breaks; the first loop then becomes
+// the target. Fails when no pearl tells the two apart or the solver gives up.
+bool MasyuGenerator::settle(Puzzle& puzzle, EdgeSet& loop, long budget) {
+    for (;;) {
+        MasyuSolver solver(puzzle);
+        const int solutions = solver.count(2, budget);
+        if (solutions < 1) return false;
+        loop = solver.solution(0);
+        if (solutions == 1) return true;
+
+        const Puzzle fits = allPearls(loop), other = allPearls(solver.solution(1));
+        std::vector<int> tells;
+        for (int v : board.vertices)
+            if (fits.pearls[v] && fits.pearls[v] != other.pearls[v] && !puzzle.pearls[v]) tells.push_back(v);
+        if (tells.empty()) return false;
+        const int v = tells[std::uniform_int_distribution<size_t>(0, tells.size() - 1)(rng)];
+        puzzle.pearls[v] = fits.pearls[v];
+    }
+}
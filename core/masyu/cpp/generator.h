@@ -0,0 +1,39 @@
+#pragma once
+#include "board.h"
+#include <random>
+
+// Puzzle generator: a random loop and every pearl it allows, then pearls
+// added until one loop fits (see settle()), then pearls removed one by one
+// while the solution stays unique. Uniqueness is only accepted when the
+// solver proves it within a budget of branch points, which bounds both
+// generation time and how hard the puzzles get.
+//
+// Loops are the boundaries of random cell regions. A region grows and
+// shrinks one cell at a time, keeping only changes after which both the
+// region and its complement are connected and no two region cells meet
+// only at a corner; that keeps the boundary one simple loop. The checks
+// are flood fills and shifts on 256-bit cell bitboards.
+class MasyuGenerator {
+public:
+    MasyuGenerator(int n, uint64_t seed) : board(n), rng(seed) {}
+
+    struct Result {
+        Puzzle puzzle;
+        EdgeSet loop;
+        long nodes = 0;   // solver branch points, the grade
+    };
+    // Up to `attempts` loops until one has a unique pearl set
+    bool generate(Result& result, long budget = 200, int attempts = 100);
+
+    EdgeSet randomLoop();
+    Puzzle allPearls(const EdgeSet& loop) const;
+
+private:
+    bool settle(Puzzle& puzzle, EdgeSet& loop, long budget);
+    bool simple(const VertexSet& region) const;
+    EdgeSet boundary(const VertexSet& region) const;
+    VertexSet grow(VertexSet seed, const VertexSet& within) const;
+
+    Board board;
+    std::mt19937_64 rng;
+};
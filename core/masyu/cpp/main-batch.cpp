@@ -0,0 +1,84 @@
+#include "generator.h"
+#include "solver.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+// mgen: generate unique, pearl-minimal puzzles in parallel. Each line of
+// the output is a web/masyu/encoder.js code followed by its grade, the
+// solver's branch points (0: propagation alone solves it). Puzzle i comes
+// from seed + i, so the output is the same for any thread count.
+int main(int argc, char* argv[]) {
+    int n = 10;
+    long count = 100;
+    uint64_t seed = 1;
+    long budget = 200;
+    int threads = 1;   // 0: one per hardware thread
+    const char* outPath = nullptr;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--size" && i + 1 < argc) usage = (n = std::atoi(argv[++i])) < MIN_SIZE || n > MAX_SIZE;
+        else if (arg == "--count" && i + 1 < argc) usage = (count = std::atol(argv[++i])) < 1;
+        else if (arg == "--budget" && i + 1 < argc) usage = (budget = std::atol(argv[++i])) < 1;
+        else if (arg == "--seed" && i + 1 < argc) seed = std::strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--threads" && i + 1 < argc) usage = (threads = std::atoi(argv[++i])) < 0;
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else usage = true;
+    }
+    if (usage) {
+        std::cerr << "Usage: " << argv[0] << " [--size 3-15] [--count n] [--budget branch-points] [--seed s] [--threads n] [--out puzzles.txt]\n";
+        return 1;
+    }
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+
+    const auto start = std::chrono::steady_clock::now();
+    std::vector<MasyuGenerator::Result> results(count);
+    std::vector<char> ok(count);
+    std::atomic<long> next{0};
+    auto work = [&] {
+        for (long i; (i = next++) < count;) {
+            MasyuGenerator generator(n, seed + i);
+            ok[i] = generator.generate(results[i], budget);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; t++) workers.emplace_back(work);
+    work();
+    for (auto& w : workers) w.join();
+
+    std::ofstream file;
+    if (outPath) file.open(outPath);
+    std::ostream& out = outPath ? file : std::cout;
+    std::map<long, long> grades;
+    long pearls = 0, failed = 0;
+    for (long i = 0; i < count; i++) {
+        if (!ok[i]) {
+            failed++;
+            continue;
+        }
+        out << results[i].puzzle.encode() << ' ' << results[i].nodes << '\n';
+        grades[results[i].nodes]++;
+        pearls += results[i].puzzle.count();
+    }
+    if (outPath && !file) {
+        std::cerr << "Error: cannot write " << outPath << std::endl;
+        return 1;
+    }
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::ostream& report = outPath ? std::cout : std::cerr;
+    report << std::format("{} puzzles of {}x{}, {} failed, {:.1f} pearls on average, {:.2f}s\n", count - failed, n, n,
+                          failed, count > failed ? double(pearls) / (count - failed) : 0.0, seconds);
+    report << "Branch points:\n";
+    for (auto [nodes, puzzles] : grades) report << std::format("    {:>6} {:>8}\n", nodes, puzzles);
+    return 0;
+}
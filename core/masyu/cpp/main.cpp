@@ -0,0 +1,18 @@
+#include "solver.h"
+#include <iostream>
+
+// msolver: solve one puzzle given as a web/masyu/encoder.js code
+int main(int argc, char* argv[]) {
+    Puzzle puzzle;
+    if (argc != 2 || !Puzzle::decode(argv[1], puzzle)) {
+        std::cerr << "Usage: " << argv[0] << " <masyu code, e.g. 4210301>\n";
+        return 1;
+    }
+
+    MasyuSolver solver(puzzle);
+    const int solutions = solver.count(2);
+    if (solutions) std::cout << draw(Board(puzzle.n), puzzle, solver.solution()) << '\n';
+    std::cout << "Solutions: " << (solutions > 1 ? "2 or more" : std::to_string(solutions)) << '\n'
+              << "Branch points: " << solver.nodes() << '\n';
+    return solutions == 1 ? 0 : 2;
+}
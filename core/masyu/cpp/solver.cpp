@@ -0,0 +1,261 @@
+#include "solver.h"
+
+MasyuSolver::MasyuSolver(const Puzzle& puzzle) : board(puzzle.n), puzzle(puzzle) {
+    for (int v : board.vertices)
+        if (puzzle.pearls[v]) pearls.push_back(v);
+}
+
+int MasyuSolver::degree(const State& s, int v) const {
+    int k = 0;
+    for (int d = 0; d < 4; d++) {
+        const int e = board.edge(v, d);
+        k += e >= 0 && s.on[e];
+    }
+    return k;
+}
+
+bool MasyuSolver::setOff(State& s, int e, bool& changed) const {
+    if (s.off[e]) return true;
+    if (s.on[e]) return false;
+    s.off[e] = 1;
+    changed = true;
+    return true;
+}
+
+bool MasyuSolver::setOn(State& s, int e, bool& changed) const {
+    if (s.on[e]) return true;
+    if (s.off[e] || s.closed) return false;
+    const int u = Board::from(e), v = Board::to(e);
+    if (degree(s, u) == 2 || degree(s, v) == 2) return false;
+    const int pu = s.partner[u], pv = s.partner[v];
+    s.on[e] = 1;
+    s.edgesOn++;
+    changed = true;
+
+    // Joining the two ends of one path closes the loop, which must then
+    // hold every edge placed so far
+    if (pu == v) return s.length[u] + 1 == s.edgesOn && close(s);
+    const int length = s.length[pu] + s.length[pv] + 1;
+    s.partner[pu] = uint8_t(pv);
+    s.partner[pv] = uint8_t(pu);
+    s.length[pu] = s.length[pv] = uint16_t(length);
+    return true;
+}
+
+// The loop is complete: every pearl must be on it, and nothing else is
+bool MasyuSolver::close(State& s) const {
+    s.closed = true;
+    for (int v : pearls)
+        if (degree(s, v) != 2) return false;
+    for (int v : board.vertices) {
+        for (int d : {RIGHT, DOWN}) {
+            const int e = board.edge(v, d);
+            if (e >= 0 && !s.on[e]) s.off[e] = 1;
+        }
+    }
+    return true;
+}
+
+bool MasyuSolver::propagateVertex(State& s, int v, bool& changed) const {
+    int k = 0, undecided = 0;
+    int open[4];
+    for (int d = 0; d < 4; d++) {
+        const int e = board.edge(v, d);
+        if (e < 0 || s.off[e]) continue;
+        if (s.on[e]) k++;
+        else open[undecided++] = e;
+    }
+
+    // Degree 0 or 2, exactly 2 on pearls
+    if (k > 2) return false;
+    if (k == 2) {
+        for (int i = 0; i < undecided; i++)
+            if (!setOff(s, open[i], changed)) return false;
+    } else if (k == 1) {
+        if (undecided == 0) return false;
+        if (undecided == 1) return setOn(s, open[0], changed);
+        // Don't join this path end to its other end early: the path must
+        // hold every edge, and every pearl must be on it
+        const int other = s.partner[v];
+        for (int i = 0; i < undecided; i++) {
+            const int w = Board::from(open[i]) == v ? Board::to(open[i]) : Board::from(open[i]);
+            if (w != other) continue;
+            bool complete = s.length[v] == s.edgesOn;
+            for (int p : pearls) complete = complete && (p == v || p == w || degree(s, p) == 2);
+            if (!complete && !setOff(s, open[i], changed)) return false;
+        }
+    } else if (puzzle.pearls[v]) {
+        if (undecided < 2) return false;
+        if (undecided == 2) return setOn(s, open[0], changed) && setOn(s, open[1], changed);
+    } else if (undecided == 1) {
+        return setOff(s, open[0], changed);
+    }
+
+    if (puzzle.pearls[v] == BLACK) {
+        // One edge per axis, each continuing straight at the next vertex
+        for (int d = 0; d < 4; d++) {
+            const int e = board.edge(v, d), o = board.edge(v, (d + 2) % 4);
+            if (e < 0 || s.off[e]) {
+                if (o < 0 || !setOn(s, o, changed)) return false;
+                continue;
+            }
+            const int next = board.edge(v + dir_step[d], d);
+            if (s.on[e]) {
+                if (next < 0 || !setOn(s, next, changed)) return false;
+                if (o >= 0 && !setOff(s, o, changed)) return false;
+            } else if (next < 0 || s.off[next]) {
+                if (!setOff(s, e, changed)) return false;
+            }
+        }
+    } else if (puzzle.pearls[v] == WHITE) {
+        // Straight along one axis, turning on at least one side
+        for (int a : {RIGHT, DOWN}) {
+            const int e1 = board.edge(v, a), e2 = board.edge(v, a + 2);
+            const int n1 = e1 < 0 ? -1 : board.edge(v + dir_step[a], a);
+            const int n2 = e2 < 0 ? -1 : board.edge(v - dir_step[a], a + 2);
+            const bool blocked = e1 < 0 || e2 < 0 || s.off[e1] || s.off[e2]
+                              || (n1 >= 0 && n2 >= 0 && s.on[n1] && s.on[n2]);
+            if (blocked) {
+                if (e1 >= 0 && !setOff(s, e1, changed)) return false;
+                if (e2 >= 0 && !setOff(s, e2, changed)) return false;
+            } else if (s.on[e1] || s.on[e2]) {
+                if (!setOn(s, e1, changed) || !setOn(s, e2, changed)) return false;
+                for (int d : {a + 1, (a + 3) % 4}) {
+                    const int f = board.edge(v, d);
+                    if (f >= 0 && !setOff(s, f, changed)) return false;
+                }
+                if (n1 >= 0 && n2 >= 0) {
+                    if (s.on[n1] && !setOff(s, n2, changed)) return false;
+                    if (s.on[n2] && !setOff(s, n1, changed)) return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+// Each band between two vertex rows is crossed by the loop's vertical
+// edges an even number of times, and likewise for columns
+bool MasyuSolver::propagateParity(State& s, bool& changed) const {
+    const int n = board.n;
+    for (int band = 0; band < n; band++) {
+        for (int d : {DOWN, RIGHT}) {
+            int on = 0, open = -1, undecided = 0;
+            for (int i = 0; i <= n; i++) {
+                const int e = board.edge(d == DOWN ? band * STRIDE + i : i * STRIDE + band, d);
+                if (s.on[e]) on++;
+                else if (!s.off[e] && undecided++ == 0) open = e;
+            }
+            if (undecided == 0 && on % 2) return false;
+            if (undecided == 1 && !(on % 2 ? setOn(s, open, changed) : setOff(s, open, changed))) return false;
+        }
+    }
+    return true;
+}
+
+// Flood the vertices reachable from the loop's edges (or from a pearl
+// before any edge is placed) through edges that are not off
+bool MasyuSolver::propagateReach(State& s, bool& changed) const {
+    int start = -1;
+    for (int v : board.vertices)
+        if (degree(s, v) || (start < 0 && puzzle.pearls[v])) start = v;
+    if (start < 0) return true;
+
+    VertexSet reached;
+    int stack[VERTICES], top = 0;
+    reached[start] = 1;
+    stack[top++] = start;
+    while (top) {
+        const int v = stack[--top];
+        for (int d = 0; d < 4; d++) {
+            const int e = board.edge(v, d);
+            if (e < 0 || s.off[e] || reached[v + dir_step[d]]) continue;
+            reached[v + dir_step[d]] = 1;
+            stack[top++] = v + dir_step[d];
+        }
+    }
+    for (int v : board.vertices) {
+        if (reached[v]) continue;
+        if (puzzle.pearls[v] || degree(s, v)) return false;
+        for (int d : {RIGHT, DOWN}) {
+            const int e = board.edge(v, d);
+            if (e >= 0 && !setOff(s, e, changed)) return false;
+        }
+    }
+    return true;
+}
+
+bool MasyuSolver::propagate(State& s) const {
+    for (bool changed = true; changed;) {
+        changed = false;
+        for (int v : board.vertices)
+            if (!propagateVertex(s, v, changed)) return false;
+        if (changed || s.closed) continue;
+        if (!propagateParity(s, changed)) return false;
+        if (!changed && !propagateReach(s, changed)) return false;
+    }
+    return true;
+}
+
+int MasyuSolver::search(State& s, int limit) {
+    if (!propagate(s)) return 0;
+    if (s.closed) {
+        if (!isSolution(board, puzzle, s.on)) return 0;
+        if (found < 2) kept[found] = s.on;
+        found++;
+        return 1;
+    }
+
+    // Branch on an edge of the most constrained path end or bare pearl
+    int branch = -1, fewest = 5;
+    for (int v : board.vertices) {
+        const int k = degree(s, v);
+        if (k == 2 || (k == 0 && !puzzle.pearls[v])) continue;
+        int undecided = 0, e0 = -1;
+        for (int d = 0; d < 4; d++) {
+            const int e = board.edge(v, d);
+            if (e >= 0 && !s.on[e] && !s.off[e] && undecided++ == 0) e0 = e;
+        }
+        if (e0 >= 0 && undecided < fewest) {
+            branch = e0;
+            fewest = undecided;
+        }
+    }
+    if (branch < 0) {
+        for (int v : board.vertices) {
+            for (int d : {RIGHT, DOWN}) {
+                const int e = board.edge(v, d);
+                if (branch < 0 && e >= 0 && !s.on[e] && !s.off[e]) branch = e;
+            }
+        }
+    }
+    if (branch < 0) return 0;
+    if (budget && branches >= budget) {
+        gaveUp = true;
+        return 0;
+    }
+
+    branches++;
+    bool changed = false;
+    int total = 0;
+    State next = s;
+    if (setOn(next, branch, changed)) total += search(next, limit);
+    if (total < limit && setOff(s, branch, changed)) total += search(s, limit - total);
+    return total;
+}
+
+int MasyuSolver::count(int limit, long budget) {
+    State s;
+    for (int v = 0; v < VERTICES; v++) {
+        s.partner[v] = uint8_t(v);
+        s.length[v] = 0;
+    }
+    found = 0;
+    branches = 0;
+    this->budget = budget;
+    gaveUp = false;
+    kept[0].reset();
+    kept[1].reset();
+    const int solutions = search(s, limit);
+    return gaveUp && solutions < limit ? -1 : solutions;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "board.h"
+
+// Masyu solver: constraint propagation over edge states with a branching
+// search when propagation stalls. Every edge is on (part of the loop), off,
+// or undecided; the on and off sets are bitboards in the Board layout.
+//
+// Propagation applies, to a fixpoint:
+//   - degrees: a vertex has 0 or 2 loop edges, a pearl exactly 2
+//   - black pearls: turn, one edge per axis, each going straight 2 steps
+//   - white pearls: straight through, and not straight on both sides
+//   - no early loops: a path's two ends can only be joined when the path
+//     holds every loop edge and the result visits every pearl
+//   - parity: a loop crosses every line between two rows (or columns) of
+//     vertices an even number of times
+//   - connectivity: edges out of reach of the loop's edges are off, and
+//     pearls out of reach are a contradiction
+class MasyuSolver {
+public:
+    explicit MasyuSolver(const Puzzle& puzzle);
+
+    // Solutions up to limit; the first two found are kept for solution().
+    // With a budget, the search gives up after that many branch points and
+    // returns -1.
+    int count(int limit = 2, long budget = 0);
+    const EdgeSet& solution(int i = 0) const { return kept[i]; }
+
+    // Branch points of the last count(): 0 when propagation alone decided
+    // the puzzle, which is how generated puzzles are graded
+    long nodes() const { return branches; }
+
+private:
+    struct State {
+        EdgeSet on, off;
+        std::array<uint8_t, VERTICES> partner;   // other end of the path ending here
+        std::array<uint16_t, VERTICES> length;   // edges of that path, at its ends
+        int edgesOn = 0;
+        bool closed = false;
+    };
+
+    int degree(const State& s, int v) const;
+    bool setOn(State& s, int e, bool& changed) const;
+    bool setOff(State& s, int e, bool& changed) const;
+    bool close(State& s) const;
+    bool propagateVertex(State& s, int v, bool& changed) const;
+    bool propagateParity(State& s, bool& changed) const;
+    bool propagateReach(State& s, bool& changed) const;
+    bool propagate(State& s) const;
+    int search(State& s, int limit);
+
+    Board board;
+    Puzzle puzzle;
+    std::vector<int> pearls;   // vertices holding a pearl
+    EdgeSet kept[2];
+    int found = 0;
+    long branches = 0;
+    long budget = 0;
+    bool gaveUp = false;
+};
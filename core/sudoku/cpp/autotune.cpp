@@ -0,0 +1,214 @@
+#include "solver.h"
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <chrono>
+
+#include <format>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <numeric>
+
+// tuner: offline search for a technique order that grades a corpus faster.
+//
+// Puzzles the singles kernel finishes never reach solve(), so only the rest
+// are kept, together with their kernel state. Each candidate order is timed
+// over those puzzles and only accepted if it solves every puzzle the default
+// order solves. There are no separate escalation thresholds to tune: solve()
+// restarts from the first step after any progress, so a step's position in
+// the order is what decides how readily the solver escalates to it.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+constexpr int STEP_COUNT = SudokuSolver::STEP_COUNT;
+
+// Per-step cost and yield, collected through the solve hooks
+struct StepProfile : SolveObserver {
+    std::array<long, STEP_COUNT> calls{}, hits{}, eliminated{}, placed{};
+    std::array<int64_t, STEP_COUNT> nanos{};
+    SolveProgress start{};
+    Clock::time_point startTime;
+
+    void beginStep(int, const SolveProgress& progress) override {
+        start = progress;
+        startTime = Clock::now();
+    }
+    void endStep(int step, bool changed, const SolveProgress& progress) override {
+        nanos[step] += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - startTime).count();
+        calls[step]++;
+        hits[step] += changed;
+        eliminated[step] += progress.eliminated - start.eliminated;
+        placed[step] += progress.placed - start.placed;
+    }
+
+    // Time spent per successful call; steps that never succeed sort last
+    double costPerHit(int step) const {
+        return hits[step] ? double(nanos[step]) / hits[step] : 1e300;
+    }
+
+    void print() const {
+        std::cout << std::format("    {:<23} {:>9} {:>9} {:>7} {:>10} {:>10} {:>12}\n", "", "calls", "progress",
+                                 "yield", "elim/call", "us/call", "us/progress");
+        for (int i = 0; i < STEP_COUNT; i++) {
+            if (!calls[i]) continue;
+            std::cout << std::format("    {:<23} {:>9} {:>9} {:>6.1f}% {:>10.2f} {:>10.3f} {:>12}\n",
+                                     SudokuSolver::step_names[i], calls[i], hits[i], 100.0 * hits[i] / calls[i],
+                                     double(eliminated[i] + placed[i]) / calls[i], nanos[i] * 1e-3 / calls[i],
+                                     hits[i] ? std::format("{:.3f}", costPerHit(i) * 1e-3) : std::string("-"));
+        }
+    }
+};
+
+struct Result {
+    int64_t nanos = 0;            // best total over the timing passes
+    std::vector<bool> solved;
+};
+
+std::string describe(const Schedule& s) {
+    std::string out;
+    for (int id : s.order) out += std::format("{}{}", out.empty() ? "" : ",", id);
+    return out;
+}
+
+class Tuner {
+public:
+    Tuner(std::vector<SinglesKernel<Geometry<3, 3>>> kernels, int passes)
+        : kernels(std::move(kernels)), passes(passes) {}
+
+    Result evaluate(const Schedule& schedule, StepProfile* profile = nullptr) const {
+        Result r;
+        r.nanos = INT64_MAX;
+        r.solved.assign(kernels.size(), false);
+        for (int pass = 0; pass < passes; pass++) {
+            const auto start = Clock::now();
+            for (size_t i = 0; i < kernels.size(); i++) {
+                SudokuSolver solver(kernels[i]);
+                solver.solve(pass == 0 ? profile : nullptr, &schedule);
+                if (pass == 0) r.solved[i] = isFilled(solver.getGrid()) && isValid(solver.getGrid());
+            }
+            // The profiled pass pays for the hooks; time the others only
+            if (pass == 0 && profile && passes > 1) continue;
+            r.nanos = std::min<int64_t>(r.nanos, std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+        }
+        return r;
+    }
+
+    size_t size() const { return kernels.size(); }
+
+private:
+    std::vector<SinglesKernel<Geometry<3, 3>>> kernels;
+    int passes;
+};
+
+bool covers(const Result& r, const Result& required) {
+    for (size_t i = 0; i < r.solved.size(); i++)
+        if (required.solved[i] && !r.solved[i]) return false;
+    return true;
+}
+
+long count(const Result& r) {
+    return std::count(r.solved.begin(), r.solved.end(), true);
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    const char* outPath = "schedule.txt";
+    long limit = 0;
+    int passes = 3;
+    int rounds = 3;
+    double margin = 0.01;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--limit" && i + 1 < argc) usage = (limit = std::atol(argv[++i])) < 1;
+        else if (arg == "--passes" && i + 1 < argc) usage = (passes = std::atoi(argv[++i])) < 1;
+        else if (arg == "--rounds" && i + 1 < argc) usage = (rounds = std::atoi(argv[++i])) < 0;
+        else if (arg == "--margin" && i + 1 < argc) usage = (margin = std::atof(argv[++i])) < 0;
+        else if (!path && arg[0] != '-') path = argv[i];
+        else usage = true;
+    }
+
+    std::ifstream fin;
+    if (path && !usage) fin.open(path, std::ios::binary);
+    if (!fin) {
+        std::cerr << "Usage: " << argv[0] << " [--out schedule.txt] [--limit puzzles] [--passes n]"
+                  << " [--rounds n] [--margin fraction] <file-with-81-char-lines>" << std::endl;
+        return 1;
+    }
+
+    std::vector<SinglesKernel<Geometry<3, 3>>> kernels;
+    long puzzles = 0;
+    for (std::string p; std::getline(fin, p) && (!limit || puzzles < limit);) {
+        if (!p.empty() && p.back() == '\r') p.pop_back();
+        if (p.size() != 81) continue;
+        puzzles++;
+        SinglesKernel<Geometry<3, 3>> kernel(p);
+        if (!kernel.run() && !kernel.contradiction()) kernels.push_back(std::move(kernel));
+    }
+    std::cout << std::format("{} puzzles, {} reach the full engine\n", puzzles, kernels.size());
+    if (kernels.empty()) return 0;
+    const Tuner tuner(std::move(kernels), passes);
+
+    // Measure every step in the default order
+    const Schedule baseline;
+    StepProfile profile;
+    const Result base = tuner.evaluate(baseline, &profile);
+    std::cout << "\nDefault order:" << std::endl;
+    profile.print();
+    std::cout << std::format("    total {:.3f}s, solved {}/{}\n", base.nanos * 1e-9, count(base), tuner.size());
+
+    Schedule best = baseline;
+    Result bestResult = base;
+    auto consider = [&](const Schedule& candidate, const char* what) {
+        const Result r = tuner.evaluate(candidate);
+        const bool accepted = covers(r, base) && r.nanos < bestResult.nanos * (1 - margin);
+        std::cout << std::format("    {:<10} {:<40} {:.3f}s solved {}{}\n", what, describe(candidate),
+                                 r.nanos * 1e-9, count(r), accepted ? "  accepted" : "");
+        if (accepted) {
+            best = candidate;
+            bestResult = r;
+        }
+        return accepted;
+    };
+
+    // Cheapest progress first, then local swaps of neighbouring steps
+    std::cout << "\nSearch:" << std::endl;
+    Schedule greedy;
+    std::stable_sort(greedy.order.begin(), greedy.order.end(),
+                     [&](int a, int b) { return profile.costPerHit(a) < profile.costPerHit(b); });
+    if (greedy.order != baseline.order) consider(greedy, "greedy");
+    for (int round = 0; round < rounds; round++) {
+        bool improved = false;
+        for (size_t k = 0; k + 1 < best.order.size(); k++) {
+            Schedule candidate = best;
+            std::swap(candidate.order[k], candidate.order[k + 1]);
+            improved |= consider(candidate, std::format("swap {}", k).c_str());
+        }
+        if (!improved) break;
+    }
+
+    StepProfile tuned;
+    tuner.evaluate(best, &tuned);
+    std::cout << "\nTuned order:" << std::endl;
+    tuned.print();
+    std::cout << std::format("    total {:.3f}s ({:+.1f}% vs default), solved {}/{}\n", bestResult.nanos * 1e-9,
+                             100.0 * (bestResult.nanos - base.nanos) / base.nanos, count(bestResult), tuner.size());
+
+    const std::string comment = std::format("tuned on {} ({} puzzles, {} past the singles kernel)\n"
+                                            "default {:.3f}s, tuned {:.3f}s, solved {}/{}",
+                                            path, puzzles, tuner.size(), base.nanos * 1e-9,
+                                            bestResult.nanos * 1e-9, count(bestResult), tuner.size());
+    if (!best.save(outPath, comment)) {
+        std::cerr << "Error: cannot write " << outPath << std::endl;
+        return 1;
+    }
+    std::cout << "\nWrote " << outPath << std::endl;
+    return 0;
+}
@@ -0,0 +1,565 @@
+#include "results.h"
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <chrono>
+
+#include <format>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <stdexcept>
+
+// bindex: a compressed bitmap index over bsolver results (--format bin),
+// and boolean queries against it.
+//
+// Every column is the set of puzzle ids with some property:
+//   all, filled, solved
+//   rating>=s        hardest step at least s (step_names index), s = 0..20
+//   <technique>>=b   technique applied at least b times, with b one of the
+//                    bucket floors below; <technique> is the results key,
+//                    e.g. xy_chain or naked_quad
+// so a range filter is one column or the difference of two.
+//
+// Bitmaps are split into chunks of 2^16 ids, each stored as a sorted list
+// of 16-bit offsets when it holds at most 4096 ids and as a 1024-word
+// bitset otherwise (the roaring layout), so sparse techniques stay small
+// and dense ones combine a word at a time. The index file is a header
+// ("SDKI", then u32 version, u32 column count, u64 puzzles), a directory
+// of (u16 name length, name, u64 offset) per column, and the columns:
+//   u32 chunk count, then per chunk u32 key, u32 cardinality and either
+//   cardinality u16 offsets or 1024 u64 words.
+// A query reads only the directory and the columns it names.
+//
+// Queries combine atoms with ! (not), & (and), | (or) and parentheses:
+//   xy_chain & !single_coloring & naked_quad<3
+//   solved & (rating>=16 | x_wing>=4)
+// An atom is a column name, or a technique or rating compared to a number
+// with <, <=, >, >= or =. Technique counts are bucketed, so a comparison
+// must fall on bucket floors.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t VERSION = 1;
+constexpr int CHUNK_WORDS = 1024;
+constexpr uint32_t ARRAY_MAX = 4096;
+constexpr std::array<uint32_t, 13> bucket_floors = {1, 2, 3, 4, 5, 6, 8, 12, 16, 24, 32, 48, 64};
+
+// Technique keys, as in results.cpp
+std::string key(const char* name) {
+    std::string k(name);
+    for (char& ch : k) {
+        if (ch == ' ' || ch == '-') ch = '_';
+        else if (ch >= 'A' && ch <= 'Z') ch = char(ch - 'A' + 'a');
+    }
+    return k;
+}
+
+template<typename T>
+void put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) std::reverse(bytes, bytes + sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+template<typename T>
+T get(const char* bytes) {
+    char copy[sizeof(T)];
+    std::memcpy(copy, bytes, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) std::reverse(copy, copy + sizeof(T));
+    T value;
+    std::memcpy(&value, copy, sizeof(T));
+    return value;
+}
+
+struct Chunk {
+    uint32_t key = 0;
+    uint32_t cardinality = 0;
+    std::vector<uint16_t> array;   // when cardinality <= ARRAY_MAX
+    std::vector<uint64_t> words;   // otherwise
+
+    bool dense() const { return cardinality > ARRAY_MAX; }
+
+    void expand(uint64_t* out) const {
+        if (dense()) {
+            std::copy(words.begin(), words.end(), out);
+            return;
+        }
+        std::fill(out, out + CHUNK_WORDS, 0);
+        for (uint16_t v : array) out[v >> 6] |= 1ull << (v & 63);
+    }
+
+    static Chunk compress(uint32_t key, const uint64_t* in) {
+        Chunk c;
+        c.key = key;
+        for (int w = 0; w < CHUNK_WORDS; w++) c.cardinality += std::popcount(in[w]);
+        if (c.dense()) {
+            c.words.assign(in, in + CHUNK_WORDS);
+            return c;
+        }
+        c.array.reserve(c.cardinality);
+        for (int w = 0; w < CHUNK_WORDS; w++)
+            for (uint64_t bits = in[w]; bits; bits &= bits - 1) c.array.push_back(uint16_t(w * 64 + std::countr_zero(bits)));
+        return c;
+    }
+
+    static Chunk fromArray(uint32_t key, std::vector<uint16_t>&& array) {
+        Chunk c;
+        c.key = key;
+        c.cardinality = uint32_t(array.size());
+        c.array = std::move(array);
+        return c;
+    }
+};
+
+class Bitmap {
+public:
+    std::vector<Chunk> chunks;   // by key
+
+    uint64_t count() const {
+        uint64_t n = 0;
+        for (const Chunk& c : chunks) n += c.cardinality;
+        return n;
+    }
+
+    template<typename F>
+    void forEach(F f) const {
+        for (const Chunk& c : chunks) {
+            const uint64_t base = uint64_t(c.key) << 16;
+            if (!c.dense()) {
+                for (uint16_t v : c.array) f(base + v);
+                continue;
+            }
+            for (int w = 0; w < CHUNK_WORDS; w++)
+                for (uint64_t bits = c.words[w]; bits; bits &= bits - 1) f(base + w * 64 + std::countr_zero(bits));
+        }
+    }
+
+    enum Op { AND, OR, AND_NOT };
+
+    // Chunks combine by key; list/list pairs merge as lists, a list against
+    // a bitset is filtered bit by bit, and anything else goes word by word
+    static Bitmap combine(const Bitmap& a, const Bitmap& b, Op op) {
+        Bitmap out;
+        uint64_t x[CHUNK_WORDS], y[CHUNK_WORDS];
+        size_t i = 0, j = 0;
+        while (i < a.chunks.size() || j < b.chunks.size()) {
+            const Chunk* ca = i < a.chunks.size() ? &a.chunks[i] : nullptr;
+            const Chunk* cb = j < b.chunks.size() ? &b.chunks[j] : nullptr;
+            if (!cb || (ca && ca->key < cb->key)) {
+                if (op != AND) out.chunks.push_back(*ca);
+                i++;
+                continue;
+            }
+            if (!ca || cb->key < ca->key) {
+                if (op == OR) out.chunks.push_back(*cb);
+                j++;
+                continue;
+            }
+            i++;
+            j++;
+
+            const uint32_t key = ca->key;
+            if (!ca->dense() && !cb->dense()) {
+                std::vector<uint16_t> merged;
+                const auto &p = ca->array, &q = cb->array;
+                auto at = std::back_inserter(merged);
+                if (op == AND) std::set_intersection(p.begin(), p.end(), q.begin(), q.end(), at);
+                else if (op == OR) std::set_union(p.begin(), p.end(), q.begin(), q.end(), at);
+                else std::set_difference(p.begin(), p.end(), q.begin(), q.end(), at);
+                if (merged.size() <= ARRAY_MAX) {
+                    if (!merged.empty()) out.chunks.push_back(Chunk::fromArray(key, std::move(merged)));
+                    continue;
+                }
+            } else if (op != OR && !ca->dense()) {
+                std::vector<uint16_t> kept;
+                for (uint16_t v : ca->array)
+                    if (bool(cb->words[v >> 6] >> (v & 63) & 1) == (op == AND)) kept.push_back(v);
+                if (!kept.empty()) out.chunks.push_back(Chunk::fromArray(key, std::move(kept)));
+                continue;
+            }
+
+            ca->expand(x);
+            cb->expand(y);
+            for (int w = 0; w < CHUNK_WORDS; w++) x[w] = op == AND ? x[w] & y[w] : op == OR ? x[w] | y[w] : x[w] & ~y[w];
+            Chunk c = Chunk::compress(key, x);
+            if (c.cardinality) out.chunks.push_back(std::move(c));
+        }
+        return out;
+    }
+
+    void write(std::string& out) const {
+        put<uint32_t>(out, uint32_t(chunks.size()));
+        for (const Chunk& c : chunks) {
+            put<uint32_t>(out, c.key);
+            put<uint32_t>(out, c.cardinality);
+            if (c.dense()) for (uint64_t w : c.words) put<uint64_t>(out, w);
+            else for (uint16_t v : c.array) put<uint16_t>(out, v);
+        }
+    }
+
+    bool read(std::istream& in) {
+        char head[8];
+        if (!in.read(head, 4)) return false;
+        const uint32_t n = get<uint32_t>(head);
+        chunks.resize(n);
+        std::string data;
+        for (Chunk& c : chunks) {
+            if (!in.read(head, 8)) return false;
+            c.key = get<uint32_t>(head);
+            c.cardinality = get<uint32_t>(head + 4);
+            if (c.cardinality == 0 || c.cardinality > (1u << 16)) return false;
+            data.resize(c.dense() ? 8 * CHUNK_WORDS : 2 * c.cardinality);
+            if (!in.read(data.data(), data.size())) return false;
+            if (c.dense()) {
+                c.words.resize(CHUNK_WORDS);
+                for (int w = 0; w < CHUNK_WORDS; w++) c.words[w] = get<uint64_t>(data.data() + 8 * w);
+            } else {
+                c.array.resize(c.cardinality);
+                for (uint32_t k = 0; k < c.cardinality; k++) c.array[k] = get<uint16_t>(data.data() + 2 * k);
+            }
+        }
+        return true;
+    }
+};
+
+// Collects ids into a bitmap. The current chunk is a plain bitset;
+// records of one results file arrive in id order, so a chunk is normally
+// done when the next one starts, but shards in any order still work.
+class BitmapBuilder {
+public:
+    void add(uint64_t id) {
+        const uint32_t key = uint32_t(id >> 16);
+        if (words.empty() || key != current) open(key);
+        words[(id & 0xFFFF) >> 6] |= 1ull << (id & 63);
+    }
+
+    Bitmap finish() {
+        close();
+        Bitmap b;
+        for (auto& [key, c] : done) b.chunks.push_back(std::move(c));
+        done.clear();
+        return b;
+    }
+
+private:
+    void open(uint32_t key) {
+        close();
+        words.assign(CHUNK_WORDS, 0);
+        current = key;
+        if (auto it = done.find(key); it != done.end()) {
+            it->second.expand(words.data());
+            done.erase(it);
+        }
+    }
+
+    void close() {
+        if (words.empty()) return;
+        done[current] = Chunk::compress(current, words.data());
+        words.clear();
+    }
+
+    std::map<uint32_t, Chunk> done;
+    std::vector<uint64_t> words;
+    uint32_t current = 0;
+};
+
+std::string techColumn(int id, uint32_t floor) { return std::format("{}>={}", key(SolverBase::tech_names[id]), floor); }
+std::string ratingColumn(int step) { return std::format("rating>={}", step); }
+
+int build(int argc, char* argv[]) {
+    const char* outPath = "results.bmi";
+    std::vector<const char*> inputs;
+    bool usage = false;
+    for (int i = 2; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg[0] != '-') inputs.push_back(argv[i]);
+        else usage = true;
+    }
+    if (usage || inputs.empty()) {
+        std::cerr << "Usage: " << argv[0] << " build [--out results.bmi] <results.bin> [more.bin ...]" << std::endl;
+        return 1;
+    }
+
+    const auto start = Clock::now();
+    std::vector<std::string> names = {"all", "filled", "solved"};
+    for (int s = 0; s < SolverBase::STEP_COUNT; s++) names.push_back(ratingColumn(s));
+    for (int id = 1; id < SolverBase::TECH_COUNT; id++)
+        for (uint32_t floor : bucket_floors) names.push_back(techColumn(id, floor));
+    std::vector<BitmapBuilder> builders(names.size());
+    const size_t RATING = 3, TECH = RATING + SolverBase::STEP_COUNT;
+
+    uint64_t records = 0, puzzles = 0;
+    std::vector<char> block;
+    for (const char* path : inputs) {
+        std::ifstream in(path, std::ios::binary);
+        char header[16];
+        if (!in.read(header, 16) || std::memcmp(header, "SDKR", 4) != 0 ||
+            get<uint32_t>(header + 4) > ResultWriter::BINARY_VERSION ||
+            get<uint32_t>(header + 8) != SolverBase::TECH_COUNT || get<uint32_t>(header + 12) != ResultWriter::RECORD_SIZE) {
+            std::cerr << "Error: " << path << " is not a bsolver --format bin results file of this version" << std::endl;
+            return 1;
+        }
+        constexpr size_t BLOCK_RECORDS = 4096;
+        block.resize(BLOCK_RECORDS * ResultWriter::RECORD_SIZE);
+        for (;;) {
+            in.read(block.data(), block.size());
+            const size_t n = size_t(in.gcount()) / ResultWriter::RECORD_SIZE;
+            for (size_t k = 0; k < n; k++) {
+                const char* r = block.data() + k * ResultWriter::RECORD_SIZE;
+                const uint64_t id = get<uint64_t>(r);
+                const uint8_t flags = uint8_t(r[8]);
+                const int rating = int8_t(r[10]);
+                builders[0].add(id);
+                if (flags & 1) builders[1].add(id);
+                if (flags & 2) builders[2].add(id);
+                for (int s = 0; s <= rating && s < SolverBase::STEP_COUNT; s++) builders[RATING + s].add(id);
+                for (int t = 1; t < SolverBase::TECH_COUNT; t++) {
+                    const uint32_t count = get<uint32_t>(r + 24 + 4 * t);
+                    for (size_t b = 0; b < bucket_floors.size() && count >= bucket_floors[b]; b++)
+                        builders[TECH + (t - 1) * bucket_floors.size() + b].add(id);
+                }
+                puzzles = std::max(puzzles, id + 1);
+            }
+            records += n;
+            if (n < BLOCK_RECORDS) break;
+        }
+    }
+
+    // Directory first, with offsets relative to the end of the header
+    std::string header, directory, columns;
+    header += "SDKI";
+    put<uint32_t>(header, VERSION);
+    put<uint32_t>(header, uint32_t(names.size()));
+    put<uint64_t>(header, puzzles);
+    std::vector<uint64_t> offsets;
+    for (size_t c = 0; c < names.size(); c++) {
+        offsets.push_back(columns.size());
+        builders[c].finish().write(columns);
+    }
+    size_t directorySize = 0;
+    for (const std::string& name : names) directorySize += 2 + name.size() + 8;
+    for (size_t c = 0; c < names.size(); c++) {
+        put<uint16_t>(directory, uint16_t(names[c].size()));
+        directory += names[c];
+        put<uint64_t>(directory, header.size() + directorySize + offsets[c]);
+    }
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    out << header << directory << columns;
+    if (!out) {
+        std::cerr << "Error: cannot write " << outPath << std::endl;
+        return 1;
+    }
+    std::cout << std::format("{} records, {} columns, {} bytes written to {}\n", records, names.size(),
+                             header.size() + directory.size() + columns.size(), outPath);
+    std::cout << std::format("Finished in {:.2f}s\n", std::chrono::duration<double>(Clock::now() - start).count());
+    return 0;
+}
+
+// An open index: the directory, and columns read on first use
+class Index {
+public:
+    bool open(const char* path) {
+        in.open(path, std::ios::binary);
+        char header[20];
+        if (!in.read(header, 20) || std::memcmp(header, "SDKI", 4) != 0 || get<uint32_t>(header + 4) != VERSION) return false;
+        const uint32_t n = get<uint32_t>(header + 8);
+        puzzles = get<uint64_t>(header + 12);
+        for (uint32_t c = 0; c < n; c++) {
+            char bytes[8];
+            if (!in.read(bytes, 2)) return false;
+            std::string name(get<uint16_t>(bytes), '\0');
+            if (!in.read(name.data(), name.size()) || !in.read(bytes, 8)) return false;
+            offsets[name] = get<uint64_t>(bytes);
+        }
+        return true;
+    }
+
+    bool has(const std::string& name) const { return offsets.count(name) != 0; }
+
+    const Bitmap& column(const std::string& name) {
+        auto cached = loaded.find(name);
+        if (cached != loaded.end()) return cached->second;
+        auto it = offsets.find(name);
+        if (it == offsets.end()) throw std::runtime_error("no column " + name);
+        Bitmap b;
+        in.clear();
+        in.seekg(std::streamoff(it->second));
+        if (!b.read(in)) throw std::runtime_error("damaged column " + name);
+        return loaded[name] = std::move(b);
+    }
+
+    uint64_t puzzles = 0;
+
+private:
+    std::ifstream in;
+    std::map<std::string, uint64_t> offsets;
+    std::map<std::string, Bitmap> loaded;
+};
+
+// Recursive descent over the query text; errors are thrown as messages
+class Query {
+public:
+    Query(Index& index, const std::string& text) : index(index), text(text) {}
+
+    Bitmap run() {
+        Bitmap result = expression();
+        skip();
+        if (at < text.size()) fail("unexpected '" + text.substr(at, 1) + "'");
+        return result;
+    }
+
+private:
+    Bitmap expression() {
+        Bitmap left = term();
+        while (accept('|')) left = Bitmap::combine(left, term(), Bitmap::OR);
+        return left;
+    }
+
+    Bitmap term() {
+        Bitmap left = factor();
+        while (accept('&')) left = Bitmap::combine(left, factor(), Bitmap::AND);
+        return left;
+    }
+
+    Bitmap factor() {
+        if (accept('!')) return Bitmap::combine(index.column("all"), factor(), Bitmap::AND_NOT);
+        if (accept('(')) {
+            Bitmap inner = expression();
+            if (!accept(')')) fail("missing ')'");
+            return inner;
+        }
+        return atom();
+    }
+
+    Bitmap atom() {
+        skip();
+        const size_t begin = at;
+        while (at < text.size() && (std::isalnum(static_cast<unsigned char>(text[at])) || text[at] == '_')) at++;
+        const std::string name = text.substr(begin, at - begin);
+        if (name.empty()) fail(at < text.size() ? "unexpected '" + text.substr(at, 1) + "'" : "unexpected end");
+
+        std::string op;
+        skip();
+        while (at < text.size() && std::strchr("<>=", text[at])) op += text[at++];
+        if (op.empty()) {
+            if (index.has(name)) return index.column(name);
+            return atLeast(name, 1);
+        }
+        skip();
+        const size_t digits = at;
+        if (at < text.size() && text[at] == '-') at++;
+        while (at < text.size() && std::isdigit(static_cast<unsigned char>(text[at]))) at++;
+        if (at == digits) fail("expected a number after " + name + op);
+        const long value = std::atol(text.substr(digits, at - digits).c_str());
+
+        const Bitmap& all = index.column("all");
+        if (op == ">=") return atLeast(name, value);
+        if (op == ">") return atLeast(name, value + 1);
+        if (op == "<") return Bitmap::combine(all, atLeast(name, value), Bitmap::AND_NOT);
+        if (op == "<=") return Bitmap::combine(all, atLeast(name, value + 1), Bitmap::AND_NOT);
+        if (op == "=" || op == "==") return Bitmap::combine(atLeast(name, value), atLeast(name, value + 1), Bitmap::AND_NOT);
+        fail("unknown comparison " + op);
+    }
+
+    // Puzzles whose technique count or rating is at least value
+    Bitmap atLeast(const std::string& name, long value) {
+        if (name == "rating") {
+            if (value <= -1) return index.column("all");
+            if (value >= SolverBase::STEP_COUNT) return Bitmap();
+            return index.column(ratingColumn(int(value)));
+        }
+        if (!index.has(name + ">=1")) fail("unknown column " + name);
+        if (value <= 0) return index.column("all");
+        if (!std::binary_search(bucket_floors.begin(), bucket_floors.end(), uint32_t(value))) bucketError(name);
+        return index.column(name + ">=" + std::to_string(value));
+    }
+
+    [[noreturn]] void bucketError(const std::string& name) {
+        std::string floors;
+        for (uint32_t f : bucket_floors) floors += std::format(" {}", f);
+        fail(name + " counts are bucketed; compare at the bucket floors" + floors);
+    }
+
+    bool accept(char ch) {
+        skip();
+        if (at < text.size() && text[at] == ch) {
+            at++;
+            return true;
+        }
+        return false;
+    }
+
+    void skip() {
+        while (at < text.size() && std::isspace(static_cast<unsigned char>(text[at]))) at++;
+    }
+
+    [[noreturn]] void fail(const std::string& message) { throw std::runtime_error(message); }
+
+    Index& index;
+    const std::string& text;
+    size_t at = 0;
+};
+
+int query(int argc, char* argv[]) {
+    const char* indexPath = nullptr;
+    const char* expression = nullptr;
+    long ids = 0;
+    bool usage = false;
+    for (int i = 2; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--ids" && i + 1 < argc) usage = (ids = std::atol(argv[++i])) < 1;
+        else if (!indexPath && arg[0] != '-') indexPath = argv[i];
+        else if (!expression) expression = argv[i];
+        else usage = true;
+    }
+    Index index;
+    if (usage || !expression || !index.open(indexPath)) {
+        std::cerr << "Usage: " << argv[0] << " query [--ids n] <results.bmi> \"xy_chain & !single_coloring & naked_quad<3\"" << std::endl;
+        return 1;
+    }
+
+    const auto start = Clock::now();
+    Bitmap result;
+    try {
+        result = Query(index, expression).run();
+    } catch (const std::runtime_error& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    const uint64_t matched = result.count();
+    const double millis = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+    if (ids) {
+        long printed = 0;
+        result.forEach([&](uint64_t id) {
+            if (printed++ < ids) std::cout << id << '\n';
+        });
+    }
+    const uint64_t total = index.column("all").count();
+    std::cout << std::format("{} of {} puzzles match ({:.2f}%), {:.2f}ms\n", matched, total,
+                             total ? 100.0 * matched / total : 0.0, millis);
+    return 0;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const std::string command = argc > 1 ? argv[1] : "";
+    if (command == "build") return build(argc, argv);
+    if (command == "query") return query(argc, argv);
+    std::cerr << "Usage: " << argv[0] << " build [--out results.bmi] <results.bin> [more.bin ...]\n"
+              << "       " << argv[0] << " query [--ids n] <results.bmi> <expression>" << std::endl;
+    return 1;
+}
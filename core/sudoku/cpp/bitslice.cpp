@@ -0,0 +1,100 @@
+#include "bitslice.h"
+#include <bit>
+
+template<typename Geo>
+SlicedBoard<Geo>::SlicedBoard(const std::array<Word, Geo::NN>& masks) {
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        for (int n = 1; n <= N; n++)
+            cand[cell][n] = (masks[cell] >> n & 1) ? ~uint64_t(0) : 0;
+        if (std::popcount(masks[cell]) == 1) done[cell] = ~uint64_t(0);
+    }
+}
+
+template<typename Geo>
+void SlicedBoard<Geo>::assume(int lane, int cell, int n) {
+    const uint64_t bit = uint64_t(1) << lane;
+    for (int m = 1; m <= N; m++)
+        if (m != n) cand[cell][m] &= ~bit;
+}
+
+template<typename Geo>
+void SlicedBoard<Geo>::setCandidates(int lane, int cell, Word mask) {
+    const uint64_t bit = uint64_t(1) << lane;
+    for (int n = 1; n <= N; n++)
+        cand[cell][n] = (mask >> n & 1) ? cand[cell][n] | bit : cand[cell][n] & ~bit;
+    done[cell] &= ~bit;
+}
+
+template<typename Geo>
+auto SlicedBoard<Geo>::candidates(int lane, int cell) const -> Word {
+    Word mask = 0;
+    for (int n = 1; n <= N; n++)
+        if (cand[cell][n] >> lane & 1) mask |= Word(1) << n;
+    return mask;
+}
+
+template<typename Geo>
+uint64_t SlicedBoard<Geo>::propagate(Word digits, uint64_t lanes) {
+    const auto& geo = Geo::get();
+    uint64_t dead = 0;
+    bool changed = true;
+
+    while (changed && (lanes &= ~dead)) {
+        changed = false;
+
+        // Naked singles: lanes where a cell has exactly one candidate left
+        for (int cell = 0; cell < Geo::NN; cell++) {
+            uint64_t pending = lanes & ~done[cell];
+            if (!pending) continue;
+            uint64_t one = 0, many = 0;
+            for (int n = 1; n <= N; n++) {
+                many |= one & cand[cell][n];
+                one |= cand[cell][n];
+            }
+            dead |= pending & ~one;
+            uint64_t single = pending & one & ~many;
+            if (!single) continue;
+            done[cell] |= single;
+
+            for (int n = 1; n <= N; n++) {
+                uint64_t placed = single & cand[cell][n];
+                if (!placed || !(digits >> n & 1)) continue;
+                for (int peer : geo.peers[cell]) {
+                    if (cand[peer][n] & placed) {
+                        cand[peer][n] &= ~placed;
+                        changed = true;
+                    }
+                }
+            }
+        }
+
+        // Hidden singles: lanes where a digit has exactly one place in a house
+        for (const auto& house : geo.houseCells) {
+            for (int n = 1; n <= N; n++) {
+                if (!(digits >> n & 1)) continue;
+                uint64_t one = 0, many = 0;
+                for (int cell : house) {
+                    many |= one & cand[cell][n];
+                    one |= cand[cell][n];
+                }
+                dead |= lanes & ~one;
+                uint64_t single = lanes & one & ~many & ~dead;
+                if (!single) continue;
+
+                for (int cell : house) {
+                    uint64_t hit = single & cand[cell][n];
+                    if (!hit) continue;
+                    for (int m = 1; m <= N; m++) {
+                        if (m != n && (cand[cell][m] & hit)) {
+                            cand[cell][m] &= ~hit;
+                            changed = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return dead;
+}
+
+SUDOKU_INSTANTIATE(SlicedBoard)
@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include "geometry.h"
+
+// Bit-sliced board: bit k of every word belongs to an independent
+// hypothesis, so singles and basic elimination run on 64 boards at once
+// with plain bitwise operations.
+template<typename Geo>
+class SlicedBoard {
+public:
+    static constexpr int N = Geo::N;
+    using Word = typename Geo::Word;
+
+    // Broadcast one board to all lanes. masks[cell] holds candidate bits 1-N;
+    // solved cells hold only their value bit.
+    explicit SlicedBoard(const std::array<Word, Geo::NN>& masks);
+
+    // In lane k, assume cell holds n
+    void assume(int lane, int cell, int n);
+
+    // In lane k, replace the candidates of cell (to be propagated again)
+    void setCandidates(int lane, int cell, Word mask);
+    Word candidates(int lane, int cell) const;
+
+    // Propagate naked and hidden singles for the digits in `digits` (bit n for
+    // digit n) on the given lanes. Returns the lanes that reached a
+    // contradiction: a cell without candidates or a house without a place
+    // for one of the digits.
+    uint64_t propagate(Word digits, uint64_t lanes);
+
+private:
+    std::array<std::array<uint64_t, N + 1>, Geo::NN> cand{};  // lanes where n is possible in cell
+    std::array<uint64_t, Geo::NN> done{};                     // lanes where the cell has been propagated
+};
+
+extern template class SlicedBoard<Geometry<2, 2>>;
+extern template class SlicedBoard<Geometry<3, 3>>;
+extern template class SlicedBoard<Geometry<4, 4>>;
+extern template class SlicedBoard<Geometry<5, 5>>;
@@ -0,0 +1,96 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <type_traits>
+#include "geometry.h"
+
+// Indexes over the candidates of unsolved cells, kept in step with every
+// candidate change so techniques can read them without rescanning the
+// board: digit positions, per-house positions (whose popcount is the
+// house's digit count, and which give conjugate pairs when it is 2), and
+// bivalue / trivalue cells. Solved cells hold no candidates here.
+template<typename Geo>
+class CandidateIndex {
+public:
+    static constexpr int N = Geo::N;
+    using Word = typename Geo::Word;
+    using CellSet = typename Geo::CellSet;
+    // Cells of a house by position in Geometry::houseCells
+    using Places = std::conditional_t<(N <= 16), uint16_t, uint32_t>;
+
+    std::array<Word, Geo::NN> mask{};                              // candidates of each cell
+    std::array<CellSet, N + 1> positions{};                        // cells holding a digit
+    std::array<std::array<Places, N + 1>, Geo::HOUSES> places{};   // same, per house
+    std::array<std::array<CellSet, N + 1>, N + 1> pairCells{};     // bivalue cells by digit pair
+    CellSet bivalue, trivalue;
+
+    int count(int house, int n) const { return std::popcount(places[house][n]); }
+
+    // The two cells of digit n in a house where it has exactly two places
+    bool conjugate(int house, int n, int& a, int& b) const {
+        const Places p = places[house][n];
+        if (std::popcount(p) != 2) return false;
+        const auto& cells = Geo::get().houseCells[house];
+        a = cells[std::countr_zero(p)];
+        b = cells[std::bit_width(p) - 1];
+        return true;
+    }
+
+    void remove(int cell, int n) {
+        positions[n][cell] = 0;
+        forPlaces(cell, [&](int h, Places bit) { places[h][n] &= Places(~bit); });
+        const Word before = mask[cell];
+        mask[cell] = Word(before & ~(Word(1) << n));
+        reclassify(cell, before);
+    }
+
+    // Any change of a cell's candidates, e.g. a rollback restoring them
+    void update(int cell, Word after) {
+        const Word before = mask[cell];
+        if (before == after) return;
+        for (Word w = before & ~after; w; w &= w - 1) {
+            const int n = std::countr_zero(w);
+            positions[n][cell] = 0;
+            forPlaces(cell, [&](int h, Places bit) { places[h][n] &= Places(~bit); });
+        }
+        for (Word w = after & ~before; w; w &= w - 1) {
+            const int n = std::countr_zero(w);
+            positions[n][cell] = 1;
+            forPlaces(cell, [&](int h, Places bit) { places[h][n] |= bit; });
+        }
+        mask[cell] = after;
+        reclassify(cell, before);
+    }
+
+private:
+    // Bit of the cell in its row, column and box
+    template<typename F>
+    static void forPlaces(int cell, F f) {
+        const int r = cell / N, c = cell % N;
+        const int b = Geo::box(r, c);
+        f(r, Places(Places(1) << c));
+        f(N + c, Places(Places(1) << r));
+        f(2 * N + b, Places(Places(1) << ((r - Geo::boxRow(b)) * Geo::BOX_COLS + c - Geo::boxCol(b))));
+    }
+
+    void reclassify(int cell, Word before) {
+        const Word after = mask[cell];
+        const int was = std::popcount(before), now = std::popcount(after);
+        if (was == 2) {
+            bivalue[cell] = 0;
+            setPair(before, cell, 0);
+        }
+        if (was == 3) trivalue[cell] = 0;
+        if (now == 2) {
+            bivalue[cell] = 1;
+            setPair(after, cell, 1);
+        }
+        if (now == 3) trivalue[cell] = 1;
+    }
+
+    void setPair(Word w, int cell, bool on) {
+        const int a = std::countr_zero(w), b = std::bit_width(w) - 1;
+        pairCells[a][b][cell] = pairCells[b][a][cell] = on;
+    }
+};
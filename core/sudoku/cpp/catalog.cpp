@@ -0,0 +1,224 @@
+#include "solver.h"
+
+#include <fstream>
+#include <vector>
+#include <string>
+#include <iostream>
+#include <chrono>
+
+#include <format>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+// catalog: grade a puzzle file and pack it for the web client.
+//
+// Puzzles are bucketed the way the client indexes them, category =
+// level * DEPTHS + depth: the level comes from the hardest step solve()
+// needed, the depth from the tercile of effort (technique applications)
+// within the level. The catalog is a 16-byte header ("SDKC", then u32
+// version, category count and record size) followed by fixed-width
+// records sorted by category and effort:
+//   41 bytes of clues, two cells per byte (low nibble first, 0 = empty),
+//   u8 hardest step (step_names index).
+// The index is a small JSON file with each category's byte offset and
+// record count, so a client fetches one category, or any record range in
+// it, with an HTTP range request instead of the whole list.
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr uint32_t VERSION = 1;
+constexpr uint32_t HEADER_SIZE = 16;
+constexpr int CLUE_BYTES = 41;
+constexpr uint32_t RECORD_SIZE = CLUE_BYTES + 1;
+
+// Easy, Medium, Hard, Diabolical, Insane, as named by the web client
+constexpr int LEVELS = 5;
+constexpr int DEPTHS = 3;
+constexpr std::array<int, SudokuSolver::STEP_COUNT> level_of_step = {
+    0, 0, 0,       // basic elimination, singles
+    1, 1, 1, 1,    // pairs, naked triples, intersection removal
+    2, 2, 2, 2,    // X-Wing, Y-Wing, XYZ-Wing, W-Wing
+    2, 2,          // rectangle elimination, chute remote pairs
+    3, 3,          // unique rectangles, BUG+1
+    3, 3, 3, 3,    // WXYZ-Wing, XY-Chain, single coloring, naked quads
+    4, 4,          // nice loops, almost locked sets
+};
+
+using Clues = std::array<uint8_t, CLUE_BYTES>;
+
+struct Entry {
+    Clues clues{};
+    int8_t step = -1;      // hardest step, -1 for none
+    int8_t category = -1;  // -1 while ungraded or unsolved
+    uint32_t effort = 0;   // technique applications
+    uint32_t line = 0;     // input order, to break ties
+};
+
+bool pack(const std::string& p, Clues& clues) {
+    clues.fill(0);
+    for (int cell = 0; cell < 81; cell++) {
+        const int v = Geometry<3, 3>::fromChar(p[cell]);
+        if (v > 9) return false;
+        clues[cell / 2] |= uint8_t(v << (cell % 2 * 4));
+    }
+    return true;
+}
+
+std::string unpack(const Clues& clues) {
+    std::string p(81, '0');
+    for (int cell = 0; cell < 81; cell++) p[cell] = char('0' + (clues[cell / 2] >> (cell % 2 * 4) & 15));
+    return p;
+}
+
+// Hardest step and effort, through the same tiers as bsolver; false if
+// the techniques can't finish the puzzle
+bool grade(Entry& e) {
+    const std::string p = unpack(e.clues);
+    SinglesKernel<Geometry<3, 3>> kernel(p);
+    if (kernel.run()) {
+        e.step = int8_t(kernel.hiddenSingles ? 2 : kernel.nakedSingles ? 1 : -1);
+        e.effort = kernel.nakedSingles + kernel.hiddenSingles;
+        return true;
+    }
+    SudokuSolver solver = kernel.contradiction() ? SudokuSolver(p) : SudokuSolver(kernel);
+    solver.solve();
+    if (!isFilled(solver.getGrid()) || !isValid(solver.getGrid())) return false;
+    e.step = int8_t(solver.getProgress().hardestStep);
+    e.effort = 0;
+    for (auto [id, cnt] : solver.getTechCount()) e.effort += cnt;
+    return true;
+}
+
+template<typename T>
+void put(std::string& out, T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) std::reverse(bytes, bytes + sizeof(T));
+    out.append(bytes, sizeof(T));
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* path = nullptr;
+    const char* outPath = "puzzles.bin";
+    const char* indexPath = nullptr;
+    long perCategory = 0;
+    int threads = 1;   // 0: one per hardware thread
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--index" && i + 1 < argc) indexPath = argv[++i];
+        else if (arg == "--per-category" && i + 1 < argc) usage = (perCategory = std::atol(argv[++i])) < 1;
+        else if (arg == "--threads" && i + 1 < argc) usage = (threads = std::atoi(argv[++i])) < 0;
+        else if (!path && arg[0] != '-') path = argv[i];
+        else usage = true;
+    }
+
+    std::ifstream fin;
+    if (path && !usage) fin.open(path, std::ios::binary);
+    if (!fin) {
+        std::cerr << "Usage: " << argv[0] << " [--out puzzles.bin] [--index puzzles.json] [--per-category n]"
+                  << " [--threads n] <file-with-81-char-lines>" << std::endl;
+        return 1;
+    }
+    const std::string index = indexPath ? indexPath : std::string(outPath) + ".json";
+
+    // Puzzles are kept packed from the start, about 50 bytes each
+    const auto start = Clock::now();
+    std::vector<Entry> entries;
+    uint32_t line = 0;
+    for (std::string p; std::getline(fin, p); line++) {
+        if (!p.empty() && p.back() == '\r') p.pop_back();
+        Entry e;
+        if (p.size() != 81 || !pack(p, e.clues)) continue;
+        e.line = line;
+        entries.push_back(e);
+    }
+    if (entries.empty()) {
+        std::cerr << "No 81-character lines found in file." << std::endl;
+        return 1;
+    }
+
+    // Grade in chunks over the pool
+    TaskPool pool(threads);
+    const int chunks = int(std::min<size_t>(entries.size(), 64 * size_t(pool.size())));
+    pool.run(chunks, [&](int k) {
+        for (size_t i = k * entries.size() / chunks; i < (k + 1) * entries.size() / chunks; i++) {
+            Entry& e = entries[i];
+            if (grade(e)) e.category = int8_t(level_of_step[std::max<int>(e.step, 0)] * DEPTHS);
+        }
+    });
+    const long unsolved = std::erase_if(entries, [](const Entry& e) { return e.category < 0; });
+
+    // Depth: terciles of effort within each level
+    auto byEffort = [](const Entry& a, const Entry& b) {
+        return a.category != b.category ? a.category < b.category
+             : a.effort != b.effort ? a.effort < b.effort : a.line < b.line;
+    };
+    std::sort(entries.begin(), entries.end(), byEffort);
+    for (size_t begin = 0, end; begin < entries.size(); begin = end) {
+        for (end = begin; end < entries.size() && entries[end].category == entries[begin].category; end++) {}
+        const size_t size = end - begin;
+        for (size_t i = begin; i < end; i++) entries[i].category += int8_t((i - begin) * DEPTHS / size);
+    }
+
+    // Categories in order; a capped category keeps an even spread of effort
+    std::array<std::vector<const Entry*>, LEVELS * DEPTHS> categories;
+    for (const Entry& e : entries) categories[e.category].push_back(&e);
+    for (auto& c : categories) {
+        if (!perCategory || long(c.size()) <= perCategory) continue;
+        std::vector<const Entry*> kept(perCategory);
+        for (long i = 0; i < perCategory; i++) kept[i] = c[i * c.size() / perCategory];
+        c = std::move(kept);
+    }
+
+    std::ofstream out(outPath, std::ios::binary | std::ios::trunc);
+    std::string buffer;
+    put<uint32_t>(buffer, 0x434b4453);   // "SDKC"
+    put<uint32_t>(buffer, VERSION);
+    put<uint32_t>(buffer, LEVELS * DEPTHS);
+    put<uint32_t>(buffer, RECORD_SIZE);
+    std::string json = std::format(R"({{"version": {}, "header_size": {}, "record_size": {}, )"
+                                   R"("levels": {}, "depths": {}, "categories": [)",
+                                   VERSION, HEADER_SIZE, RECORD_SIZE, LEVELS, DEPTHS);
+    uint64_t offset = HEADER_SIZE;
+    long written = 0;
+    for (int c = 0; c < LEVELS * DEPTHS; c++) {
+        for (const Entry* e : categories[c]) {
+            buffer.append(reinterpret_cast<const char*>(e->clues.data()), CLUE_BYTES);
+            put<uint8_t>(buffer, uint8_t(e->step));
+            if (buffer.size() >= (1 << 16)) {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        const size_t count = categories[c].size();
+        json += std::format(R"({}{{"level": {}, "depth": {}, "offset": {}, "count": {}}})", c ? ", " : "",
+                            c / DEPTHS, c % DEPTHS, offset, count);
+        offset += count * RECORD_SIZE;
+        written += count;
+    }
+    out.write(buffer.data(), buffer.size());
+    json += "]}\n";
+    std::ofstream indexOut(index, std::ios::binary | std::ios::trunc);
+    indexOut << json;
+    if (!out || !indexOut) {
+        std::cerr << "Error: cannot write " << (out ? index.c_str() : outPath) << std::endl;
+        return 1;
+    }
+
+    std::cout << std::format("{} puzzles, {} unsolved by the techniques, {} written to {} ({} bytes), index {}\n",
+                             entries.size() + unsolved, unsolved, written, outPath, offset, index);
+    for (int c = 0; c < LEVELS * DEPTHS; c++)
+        std::cout << std::format("    level {} depth {} {:>9}\n", c / DEPTHS, c % DEPTHS, categories[c].size());
+    std::cout << std::format("Finished in {:.2f}s\n", std::chrono::duration<double>(Clock::now() - start).count());
+    return 0;
+}
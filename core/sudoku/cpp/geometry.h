@@ -0,0 +1,117 @@
+#pragma once
+#include <array>
+#include <bit>
+#include <bitset>
+#include <cstdint>
+#include <type_traits>
+
+// Candidate digits 1..N of a cell as an unsigned mask (bit n = digit n),
+// with the std::bitset interface the techniques use. The word is the
+// smallest of uint16/uint32/uint64 that holds N+1 bits.
+template<int N>
+class DigitMask {
+public:
+    using Word = std::conditional_t<(N < 16), uint16_t,
+                 std::conditional_t<(N < 32), uint32_t, uint64_t>>;
+    static constexpr Word ALL = Word(Word(~Word(0)) >> (8 * sizeof(Word) - N - 1));
+
+    class reference {
+        Word& w; Word bit;
+    public:
+        reference(Word& w, int i) : w(w), bit(Word(1) << i) {}
+        reference& operator=(bool v) { w = v ? Word(w | bit) : Word(w & ~bit); return *this; }
+        reference& operator=(const reference& o) { return *this = bool(o); }
+        operator bool() const { return w & bit; }
+    };
+
+    constexpr DigitMask() = default;
+    constexpr explicit DigitMask(Word w) : w(w & ALL) {}
+
+    bool operator[](int i) const { return (w >> i) & 1; }
+    reference operator[](int i) { return reference(w, i); }
+    int count() const { return std::popcount(w); }
+    bool any() const { return w != 0; }
+    bool none() const { return w == 0; }
+    static constexpr int size() { return N + 1; }
+    Word to_ulong() const { return w; }
+    DigitMask& set() { w = ALL; return *this; }
+    DigitMask& reset() { w = 0; return *this; }
+
+    DigitMask& operator&=(DigitMask o) { w &= o.w; return *this; }
+    DigitMask& operator|=(DigitMask o) { w |= o.w; return *this; }
+    DigitMask operator&(DigitMask o) const { return DigitMask(Word(w & o.w)); }
+    DigitMask operator|(DigitMask o) const { return DigitMask(Word(w | o.w)); }
+    DigitMask operator~() const { return DigitMask(Word(~w)); }
+    bool operator==(const DigitMask&) const = default;
+
+private:
+    Word w = 0;
+};
+
+// Precomputed board geometry for an N x N grid of BR x BC boxes. Cells are
+// indexed r*N + c, houses 0..N-1 are rows, N..2N-1 columns and 2N..3N-1 boxes.
+template<int BR, int BC>
+struct Geometry {
+    static constexpr int BOX_ROWS = BR;
+    static constexpr int BOX_COLS = BC;
+    static constexpr int N = BR * BC;
+    static constexpr int NN = N * N;
+    static constexpr int HOUSES = 3 * N;
+    static constexpr int PEERS = 2 * (N - 1) + (BR - 1) * (BC - 1);
+    using Mask = DigitMask<N>;
+    using Word = typename Mask::Word;
+    using CellSet = std::bitset<NN>;
+
+    static constexpr int box(int r, int c) { return (r / BR) * BR + c / BC; }
+    static constexpr int boxRow(int b) { return (b / BR) * BR; }   // top row of box b
+    static constexpr int boxCol(int b) { return (b % BR) * BC; }   // left column of box b
+
+    // Puzzle strings use '0' or '.' for empty cells, then 1-9, A-Z
+    static constexpr int fromChar(char ch) {
+        if (ch >= '1' && ch <= '9') return ch - '0';
+        if (ch >= 'A' && ch <= 'Z') return ch - 'A' + 10;
+        if (ch >= 'a' && ch <= 'z') return ch - 'a' + 10;
+        return 0;
+    }
+    static constexpr char toChar(int v) {
+        return v == 0 ? '.' : v <= 9 ? char('0' + v) : char('A' + v - 10);
+    }
+
+    std::array<std::array<int, 3>, NN> houseOf{};       // row, col, box house of each cell
+    std::array<std::array<int, N>, HOUSES> houseCells{};
+    std::array<std::array<int, PEERS>, NN> peers{};
+    std::array<CellSet, NN> peerMask{};                  // peers of a cell, excluding itself
+    std::array<CellSet, HOUSES> houseMask{};
+
+    Geometry() {
+        std::array<int, HOUSES> fill{};
+        for (int cell = 0; cell < NN; cell++) {
+            int r = cell / N, c = cell % N;
+            houseOf[cell] = {r, N + c, 2 * N + box(r, c)};
+            for (int h : houseOf[cell]) {
+                houseCells[h][fill[h]++] = cell;
+                houseMask[h][cell] = 1;
+            }
+        }
+        for (int cell = 0; cell < NN; cell++) {
+            for (int h : houseOf[cell]) peerMask[cell] |= houseMask[h];
+            peerMask[cell][cell] = 0;
+            int k = 0;
+            for (int other = 0; other < NN; other++)
+                if (peerMask[cell][other]) peers[cell][k++] = other;
+        }
+    }
+
+    static const Geometry& get() {
+        static const Geometry geo;
+        return geo;
+    }
+};
+
+// Board sizes the engine is compiled for. Every translation unit that
+// defines members of a geometry template instantiates them for all of these.
+#define SUDOKU_INSTANTIATE(Class) \
+    template class Class<Geometry<2, 2>>; \
+    template class Class<Geometry<3, 3>>; \
+    template class Class<Geometry<4, 4>>; \
+    template class Class<Geometry<5, 5>>;
@@ -1,4 +1,8 @@
 #include "solver.h"
+#include "perf.h"
+#include "trace.h"
+#include "results.h"
+#include "stats.h"
 
 #include <fstream>
 #include <vector>
@@ -9,100 +13,402 @@
 #include <format>
 #include <map>
 #include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <optional>
 
+// --perf: hardware counter totals per technique step and per tier. Tier
+// totals include the counter reads made for the steps inside them.
+struct PerfProfile : SolveObserver {
+    using Reading = PerfCounters::Reading;
+    PerfCounters counters;
+    std::array<Reading, SudokuSolver::STEP_COUNT> steps{};
+    std::array<long, SudokuSolver::STEP_COUNT> calls{};
+    std::array<Reading, 2> tiers{};
+    Reading stepStart{}, tierStart{};
 
-int main(int argc, char* argv[]) {
-    std::vector<std::string> puzzles;
+    void beginStep(int, const SolveProgress&) override { stepStart = counters.read(); }
+    void endStep(int step, bool, const SolveProgress&) override {
+        accumulate(steps[step], stepStart);
+        calls[step]++;
+    }
+    void beginTier() { tierStart = counters.read(); }
+    void endTier(int tier) { accumulate(tiers[tier], tierStart); }
 
-    std::vector<std::map<int,int>> batch_stats;
-    batch_stats.reserve(10000);
+    void accumulate(Reading& total, const Reading& since) const {
+        const Reading now = counters.read();
+        for (int e = 0; e < PerfCounters::EVENT_COUNT; e++) total.values[e] += now.values[e] - since.values[e];
+        total.enabled += now.enabled - since.enabled;
+        total.running += now.running - since.running;
+    }
 
-    if (argc == 2) {
-        std::ifstream fin(argv[1]);
-        std::string line;
-        while (std::getline(fin, line)) {
-            if (line.size() == 81) puzzles.push_back(line);
+    // Counts of a multiplexed group are scaled up to the whole enabled time
+    // and marked with '*'; a group that never ran has no counts at all
+    void print(const std::array<long, 2>& tierPuzzles) const {
+        std::cout << "\nHardware counters:" << std::endl;
+        if (!counters.any()) {
+            std::cout << "    unavailable (" << counters.error() << ")" << std::endl;
+            return;
         }
-        if (puzzles.empty()) {
-            std::cerr << "No 81-character lines found in file." << std::endl;
+        bool scaled = false, missed = false;
+        auto value = [&](const Reading& r, PerfCounters::Event e) {
+            if (!counters.available(e)) return std::string("n/a");
+            if (!r.running) return std::string("not counted");
+            if (r.running == r.enabled) return std::to_string(r.values[e]);
+            return std::to_string(uint64_t(double(r.values[e]) * r.enabled / r.running)) + "*";
+        };
+        auto row = [&](const char* name, long n, const Reading& r) {
+            const auto& v = r.values;
+            double ipc = v[PerfCounters::CYCLES] ? double(v[PerfCounters::INSTRUCTIONS]) / v[PerfCounters::CYCLES] : 0;
+            scaled |= r.running && r.running < r.enabled;
+            missed |= !r.running;
+            std::cout << std::format("    {:<23} {:>8} {:>14} {:>14} {:>5.2f} {:>12} {:>12} {:>12}\n", name, n,
+                                     value(r, PerfCounters::CYCLES), value(r, PerfCounters::INSTRUCTIONS), ipc,
+                                     value(r, PerfCounters::BRANCH_MISSES), value(r, PerfCounters::L1D_MISSES),
+                                     value(r, PerfCounters::LLC_MISSES));
+        };
+        std::cout << std::format("    {:<23} {:>8} {:>14} {:>14} {:>5} {:>12} {:>12} {:>12}\n", "", "calls",
+                                 "cycles", "instructions", "IPC", "br-misses", "L1d-misses", "LLC-misses");
+        row("Tier: singles kernel", tierPuzzles[0], tiers[0]);
+        row("Tier: full engine", tierPuzzles[1], tiers[1]);
+        for (int i = 0; i < SudokuSolver::STEP_COUNT; i++)
+            if (calls[i]) row(SudokuSolver::step_names[i], calls[i], steps[i]);
+        if (scaled)
+            std::cout << "    * scaled: the events were multiplexed and counted only part of the time" << std::endl;
+        if (missed)
+            std::cout << "    not counted: the kernel never put the events on the PMU, e.g. while the NMI watchdog holds a counter" << std::endl;
+        if (!counters.error().empty())
+            std::cout << "    some events unavailable (" << counters.error() << ")" << std::endl;
+    }
+};
+
+// Forwards step hooks to every enabled observer
+struct Observers : SolveObserver {
+    std::vector<SolveObserver*> list;
+    void beginStep(int step, const SolveProgress& progress) override {
+        for (auto* o : list) o->beginStep(step, progress);
+    }
+    void endStep(int step, bool changed, const SolveProgress& progress) override {
+        for (auto* o : list) o->endStep(step, changed, progress);
+    }
+};
+
+// bsolver merge [--save merged.stats] shard.stats...: add up the aggregates
+// of shards graded separately
+int merge(int argc, char* argv[]) {
+    const char* savePath = nullptr;
+    std::vector<const char*> paths;
+    for (int i = 2; i < argc; i++) {
+        if (std::string(argv[i]) == "--save" && i + 1 < argc) savePath = argv[++i];
+        else paths.push_back(argv[i]);
+    }
+    if (paths.empty()) {
+        std::cerr << "Usage: " << argv[0] << " merge [--save merged.stats] <shard.stats>..." << std::endl;
+        return 1;
+    }
+
+    BatchStats total;
+    std::vector<int> seen;
+    for (const char* path : paths) {
+        BatchStats shard;
+        if (!shard.load(path)) {
+            std::cerr << "Error: " << path << " is not a bsolver stats file" << std::endl;
             return 1;
         }
-    } else {
-        std::cerr << "Usage: " << argv[0] << " <file-with-81-char-lines>" << std::endl;
+        if (!shard.done) std::cerr << "Warning: " << path << " is an unfinished run" << std::endl;
+        if (seen.empty()) seen.assign(shard.shards, 0);
+        if (shard.shards != int(seen.size()))
+            std::cerr << "Warning: " << path << " is shard " << shard.shard << "/" << shard.shards
+                      << " but other inputs have " << seen.size() << " shards" << std::endl;
+        else if (seen[shard.shard]++)
+            std::cerr << "Warning: shard " << shard.shard << " is counted more than once" << std::endl;
+        total.merge(shard);
+    }
+    for (size_t i = 0; i < seen.size(); i++)
+        if (!seen[i]) std::cerr << "Warning: shard " << i << "/" << seen.size() << " is missing" << std::endl;
+
+    total.done = true;
+    total.print(std::cout);
+    if (savePath && !total.save(savePath)) {
+        std::cerr << "Error: cannot write " << savePath << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1 && std::string(argv[1]) == "merge") return merge(argc, argv);
+
+    std::unique_ptr<PerfProfile> perf;
+    std::unique_ptr<TraceRecorder> trace;
+    const char* tracePath = nullptr;
+    double traceThresholdMs = 10;
+    const char* outPath = nullptr;
+    ResultWriter::Format outFormat = ResultWriter::JSONL;
+    const char* checkpointPath = nullptr;
+    long checkpointEvery = 10000;
+    BatchStats stats;
+    std::unique_ptr<Schedule> schedule;
+    const char* schedulePath = nullptr;
+    bool minimality = false;
+    int backdoorCap = 0;
+    int threads = 1;   // 0: one per hardware thread
+    const char* path = nullptr;
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--perf") perf = std::make_unique<PerfProfile>();
+        else if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--trace-threshold" && i + 1 < argc) traceThresholdMs = std::atof(argv[++i]);
+        else if (arg == "--out" && i + 1 < argc) outPath = argv[++i];
+        else if (arg == "--format" && i + 1 < argc) usage = !ResultWriter::parseFormat(argv[++i], outFormat);
+        else if (arg == "--shard" && i + 1 < argc) {
+            usage = std::sscanf(argv[++i], "%d/%d", &stats.shard, &stats.shards) != 2
+                    || stats.shards < 1 || stats.shard < 0 || stats.shard >= stats.shards;
+        }
+        else if (arg == "--checkpoint" && i + 1 < argc) checkpointPath = argv[++i];
+        else if (arg == "--checkpoint-every" && i + 1 < argc) usage = (checkpointEvery = std::atol(argv[++i])) < 1;
+        else if (arg == "--schedule" && i + 1 < argc) schedulePath = argv[++i];
+        else if (arg == "--minimality") minimality = true;
+        else if (arg == "--backdoor" && i + 1 < argc)
+            usage = (backdoorCap = std::atoi(argv[++i])) < 1 || backdoorCap > BatchStats::MAX_BACKDOOR;
+        else if (arg == "--threads" && i + 1 < argc) usage = (threads = std::atoi(argv[++i])) < 0;
+        else if (!path && arg[0] != '-') path = argv[i];
+        else usage = true;
+    }
+
+    std::ifstream fin;
+    if (path && !usage) fin.open(path, std::ios::binary);
+    if (!fin) {
+        std::cerr << "Usage: " << argv[0] << " [--perf] [--trace out.json [--trace-threshold ms]]"
+                  << " [--out results [--format jsonl|csv|bin]]"
+                  << " [--shard i/N] [--checkpoint run.stats [--checkpoint-every puzzles]]"
+                  << " [--schedule profile.txt] [--minimality] [--backdoor max-cells [--threads n]]"
+                  << " <file-with-81-char-lines>" << std::endl
+                  << "       " << argv[0] << " merge [--save merged.stats] <shard.stats>..." << std::endl;
         return 1;
     }
 
+    if (schedulePath) {
+        schedule = std::make_unique<Schedule>();
+        std::string error;
+        if (!schedule->load(schedulePath, error)) {
+            std::cerr << "Error: " << error << std::endl;
+            return 1;
+        }
+    }
+
+    // Resume where an earlier run of the same shard stopped
+    bool resumed = false;
+    if (checkpointPath && std::filesystem::exists(checkpointPath)) {
+        BatchStats saved;
+        if (!saved.load(checkpointPath)) {
+            std::cerr << "Error: " << checkpointPath << " is not a bsolver stats file" << std::endl;
+            return 1;
+        }
+        if (saved.shard != stats.shard || saved.shards != stats.shards) {
+            std::cerr << "Error: " << checkpointPath << " belongs to shard " << saved.shard << "/" << saved.shards << std::endl;
+            return 1;
+        }
+        if (saved.done) {
+            std::cout << "Already finished; delete " << checkpointPath << " to grade again" << std::endl;
+            saved.print(std::cout);
+            return 0;
+        }
+        stats = saved;
+        fin.seekg(stats.offset);
+        resumed = true;
+    }
+
+    // Per-puzzle rows are streamed; nothing below grows with the corpus. On
+    // resume, rows written after the last checkpoint are cut off first.
+    std::ofstream fout;
+    std::unique_ptr<ResultWriter> results;
+    if (outPath) {
+        std::error_code ec;
+        if (resumed) std::filesystem::resize_file(outPath, stats.resultsSize, ec);
+        fout.open(outPath, std::ios::binary | (resumed ? std::ios::app : std::ios::trunc));
+        if (!fout || ec) {
+            std::cerr << "Error: cannot write results to " << outPath << std::endl;
+            return 1;
+        }
+        results = std::make_unique<ResultWriter>(fout, outFormat, !resumed);
+    }
+
+    // Step hooks for the enabled modes
+    Observers observers;
+    if (perf) observers.list.push_back(perf.get());
+    if (tracePath) {
+        trace = std::make_unique<TraceRecorder>();
+        observers.list.push_back(trace.get());
+    }
+    SolveObserver* observer = observers.list.empty() ? nullptr
+                            : observers.list.size() == 1 ? observers.list[0] : &observers;
+    int tracedPuzzles = 0;
+
+    // Save position and aggregates; results are flushed first so the
+    // checkpoint never points past rows that are not on disk
+    const uint64_t resumeLine = stats.line;
+    auto checkpoint = [&](uint64_t nextLine) {
+        stats.line = nextLine;
+        stats.offset = stats.done ? -1 : int64_t(fin.tellg());
+        if (results) {
+            results->flush();
+            fout.flush();
+            stats.resultsSize = fout.tellp();
+        }
+        if (!stats.save(checkpointPath)) std::cerr << "Error: cannot write checkpoint " << checkpointPath << std::endl;
+    };
+    if (checkpointPath && !resumed) checkpoint(0);
+
+    // Backdoor searches fan out over the open cells
+    std::unique_ptr<TaskPool> pool;
+    if (backdoorCap && threads != 1) pool = std::make_unique<TaskPool>(threads);
+    stats.backdoorCap = std::max(stats.backdoorCap, backdoorCap);
+
     // Start the timer
     const auto globalStart = std::chrono::steady_clock::now();
 
-    int errorEmptyCandidates = 0;
-    int errorWrongSolution = 0;
-    int filled = 0;
-    int solved = 0;
-    for (const auto& p : puzzles) {
-        SudokuSolver solver(p);
-        solver.solve();
-
-        const auto& grid = solver.getGrid();
-        const auto& candidates = solver.getCandidates();
-        const auto& tech_count = solver.getTechCount();
-
-        // check for empty candidates error
-        bool checkEmptyCandidates = false;
-        for (int r = 0; r < 9; ++r) {
-            for (int c = 0; c < 9; ++c) {
-                if (candidates[r][c].count() == 0 && grid[r][c] == 0) {
-                    checkEmptyCandidates = true;
+    // Tiered pipeline: the singles kernel first, the full engine only for
+    // the puzzles it can't finish
+    using BatchStats::TIER_SINGLES, BatchStats::TIER_FULL;
+    long sinceCheckpoint = 0;
+    long puzzlesThisRun = 0;
+    std::string p;
+    uint64_t lineNo = stats.line;
+    for (; std::getline(fin, p); lineNo++) {
+        if (!p.empty() && p.back() == '\r') p.pop_back();
+        if (p.size() != 81 || lineNo % stats.shards != uint64_t(stats.shard)) continue;
+        puzzlesThisRun++;
+
+        PuzzleResult result;
+        result.id = lineNo;
+        const auto tierStart = std::chrono::steady_clock::now();
+        if (perf) perf->beginTier();
+        if (trace) {
+            trace->beginPuzzle(p);
+            trace->beginKernel();
+        }
+        SinglesKernel<Geometry<3, 3>> kernel(p);
+        const bool finished = kernel.run();
+        if (trace) trace->endKernel(finished, kernel.nakedSingles, kernel.hiddenSingles);
+        int tier = TIER_SINGLES;
+        std::optional<SudokuSolver> stalled;   // kept for --backdoor
+
+        if (finished) {
+            result.filled = result.solved = true;
+            result.techCount[SudokuSolver::BASIC_ELIM] = 1;
+            result.techCount[SudokuSolver::NAKED_SINGLE] = kernel.nakedSingles;
+            result.techCount[SudokuSolver::HIDDEN_SINGLE] = kernel.hiddenSingles;
+            result.rating = kernel.hiddenSingles ? 2 : kernel.nakedSingles ? 1 : -1;
+        } else {
+            // Promote with the kernel's state; a contradictory puzzle starts over
+            // so the error checks below see the full engine's view of it
+            tier = TIER_FULL;
+            SudokuSolver solver = kernel.contradiction() ? SudokuSolver(p) : SudokuSolver(kernel);
+            solver.solve(observer, schedule.get());
+
+            const auto& grid = solver.getGrid();
+            const auto& candidates = solver.getCandidates();
+
+            // check for empty candidates error
+            for (int r = 0; r < 9; ++r) {
+                for (int c = 0; c < 9; ++c) {
+                    if (candidates[r][c].count() == 0 && grid[r][c] == 0) {
+                        result.error = PuzzleResult::EMPTY_CANDIDATES;
+                    }
                 }
             }
+
+            // check if grid is filled
+            if (isFilled(grid)) {
+                result.filled = true;
+                result.solved = isValid(grid);
+                if (!result.solved) result.error = PuzzleResult::WRONG_SOLUTION;
+            }
+
+            for (auto [id, cnt] : solver.getTechCount()) result.techCount[id] = cnt;
+            result.rating = solver.getProgress().hardestStep;
+            if (backdoorCap && !result.filled && result.error == PuzzleResult::NONE) stalled = std::move(solver);
         }
-        if (checkEmptyCandidates) {
-            errorEmptyCandidates++;
+
+        const auto elapsed = std::chrono::steady_clock::now() - tierStart;
+        result.nanos = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        stats.tierPuzzles[tier]++;
+        stats.tierNanos[tier] += result.nanos;
+        if (perf) perf->endTier(tier);
+
+        // Keep traces of outliers only; the span ends with the solve
+        if (trace && trace->endPuzzle(result.filled) < traceThresholdMs * 1000) trace->discardPuzzle();
+        else if (trace) tracedPuzzles++;
+
+        // Uniqueness and redundant clues, outside the timed and traced solve
+        if (minimality) {
+            ClueAnalysis clues = analyzeClues(p);
+            stats.cluesAnalyzed++;
+            stats.noSolution += clues.solutions == 0;
+            stats.multipleSolutions += clues.solutions > 1;
+            stats.minimal += clues.minimal();
+            stats.redundantClues += clues.redundant.size();
+            result.solutions = int8_t(clues.solutions);
+            result.redundant = std::move(clues.redundant);
         }
 
-        // check if grid is filled
-        if (isFilled(grid)) {
-            filled++;
-            if (isValid(grid)) {
-                solved++;
-            } else {
-                errorWrongSolution++;
-            }
+        // Distance of a stalled solve from the techniques finishing it,
+        // for puzzles with a unique solution; like the clue analysis it
+        // runs after the puzzle's trace span has ended
+        std::vector<std::vector<int>> solution;
+        if (stalled && countSolutions(p, &solution) == 1) {
+            stalled->setParallel(pool.get());
+            auto backdoor = stalled->findBackdoor(solution, backdoorCap, schedule.get());
+            result.backdoor = int8_t(backdoor.cells.size());
+            result.backdoorCells = std::move(backdoor.cells);
+            stats.backdoors[result.backdoor]++;
         }
 
-        // save tech statistics
-        batch_stats.emplace_back(tech_count);
+        stats.puzzles++;
+        stats.filled += result.filled;
+        stats.solved += result.solved;
+        stats.errorEmptyCandidates += result.error == PuzzleResult::EMPTY_CANDIDATES;
+        stats.errorWrongSolution += result.error == PuzzleResult::WRONG_SOLUTION;
+        for (int id = 0; id < SudokuSolver::TECH_COUNT; id++) stats.techCount[id] += result.techCount[id];
+        if (results) results->write(result);
+
+        if (checkpointPath && ++sinceCheckpoint >= checkpointEvery) {
+            checkpoint(lineNo + 1);
+            sinceCheckpoint = 0;
+        }
+    }
+    if (stats.puzzles == 0) {
+        std::cerr << "No 81-character lines found in file." << std::endl;
+        return 1;
     }
 
     // Stop the timer
     const auto globalEnd = std::chrono::steady_clock::now();
     const std::chrono::duration<double> elapsed = globalEnd - globalStart; // in seconds
 
-    // Accumulate tech statistics
-    std::vector<int> total(26, 0);
-    for (const auto& m : batch_stats)
-        for (auto [id, cnt] : m)
-            total[id] += cnt;
-
-    std::vector<std::pair<int, int>> ordered;
-    for (std::size_t id = 0; id < total.size(); ++id)
-        // if (total[id] != 0)
-        ordered.emplace_back(static_cast<int>(id), total[id]);
-    std::stable_sort(ordered.begin(), ordered.end(),
-                     [](auto& a, auto& b) { return a.second > b.second; });
-
     // Print results
-    std::cout << "\nErrors: " << std::endl 
-              << "    Empty Candidates        " << errorEmptyCandidates << std::endl
-              << "    Wrong Solution          " << errorWrongSolution 
-              << std::endl;
-    std::cout << "\nSolved:" << std::endl
-              << "                            " << solved << "/" << puzzles.size() << std::endl;
-    std::cout << "\nUsed:"  << std::endl;
-    for (auto [id, cnt] : ordered) {
-        std::cout << std::format("    {0:<{1}} {2}\n", SudokuSolver::tech_names[id], 23, cnt);
+    stats.print(std::cout);
+    if (perf) perf->print(stats.tierPuzzles);
+    if (trace) {
+        std::ofstream out(tracePath);
+        trace->write(out);
+        std::cout << std::format("\nTraced {} puzzle(s) over {} ms to {}\n", tracedPuzzles, traceThresholdMs, tracePath);
+        if (!out) std::cerr << "Error: cannot write trace to " << tracePath << std::endl;
+    }
+    if (results) {
+        results->flush();
+        if (!fout) std::cerr << "Error: cannot write results to " << outPath << std::endl;
+    }
+    if (checkpointPath) {
+        stats.done = true;
+        checkpoint(lineNo);
     }
 
+    if (resumed) std::cout << std::format("\nResumed at line {}; graded {} puzzle(s) in this run\n", resumeLine, puzzlesThisRun);
     std::cout << std::format("\nFinished in {:.2f}s\n", elapsed.count());
     return 0;
 }
@@ -1,20 +1,22 @@
 #include "solver.h"
+#include "trace.h"
+#include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <memory>
 
-int main(int argc, char* argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <81-char sudoku string>\n";
-        return 1;
-    }
-    
-    std::string input(argv[1]);
-    if (input.length() != 81) {
-        std::cerr << "Error: Input must be exactly 81 characters\n";
-        return 1;
+template<typename Solver>
+int run(const std::string& input, const char* tracePath, int threads) {
+    TraceRecorder trace;
+    if (tracePath) trace.beginPuzzle(input);
+
+    Solver solver(input);
+    std::unique_ptr<TaskPool> pool;
+    if (threads != 1) {
+        pool = std::make_unique<TaskPool>(threads);
+        solver.setParallel(pool.get());
     }
-    
-    SudokuSolver solver(input);
-    solver.solve();
+    solver.solve(tracePath ? &trace : nullptr);
 
     const auto& grid = solver.getGrid();
     const auto& candidates = solver.getCandidates();
@@ -26,6 +28,45 @@ int main(int argc, char* argv[]) {
     solver.printResults();
     // solver.printCandidates();
 
+    if (tracePath) {
+        trace.endPuzzle(isFilled(grid));
+        std::ofstream out(tracePath);
+        trace.write(out);
+        if (!out) {
+            std::cerr << "Error: cannot write trace to " << tracePath << "\n";
+            return 1;
+        }
+    }
     
     return 0;
-}
\ No newline at end of file
+}
+
+int main(int argc, char* argv[]) {
+    const char* tracePath = nullptr;
+    const char* puzzle = nullptr;
+    int threads = 1;   // 0: one per hardware thread
+    bool usage = false;
+    for (int i = 1; i < argc && !usage; i++) {
+        std::string arg = argv[i];
+        if (arg == "--trace" && i + 1 < argc) tracePath = argv[++i];
+        else if (arg == "--threads" && i + 1 < argc) usage = (threads = std::atoi(argv[++i])) < 0;
+        else if (!puzzle && arg[0] != '-') puzzle = argv[i];
+        else usage = true;
+    }
+    if (!puzzle || usage) {
+        std::cerr << "Usage: " << argv[0] << " [--trace out.json] [--threads n]"
+                  << " <sudoku string: 16, 81, 256 or 625 chars>\n";
+        return 1;
+    }
+    
+    // The board size follows from the input length
+    std::string input(puzzle);
+    switch (input.length()) {
+        case 16:  return run<SudokuSolver4>(input, tracePath, threads);
+        case 81:  return run<SudokuSolver>(input, tracePath, threads);
+        case 256: return run<SudokuSolver16>(input, tracePath, threads);
+        case 625: return run<SudokuSolver25>(input, tracePath, threads);
+    }
+    std::cerr << "Error: Input must be 16, 81, 256 or 625 characters\n";
+    return 1;
+}
@@ -0,0 +1,51 @@
+#include "parallel.h"
+#include <algorithm>
+
+TaskPool::TaskPool(int threads) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < threads; i++) workers.emplace_back([this] { work(); });
+}
+
+TaskPool::~TaskPool() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+bool TaskPool::step(std::unique_lock<std::mutex>& lock, Job& job) {
+    if (job.next == job.count) {
+        std::erase(jobs, &job);
+        return false;
+    }
+    const int i = job.next++;
+    lock.unlock();
+    (*job.task)(i);
+    lock.lock();
+    if (++job.done == job.count) finished.notify_all();
+    return true;
+}
+
+void TaskPool::run(int count, const std::function<void(int)>& task) {
+    if (workers.empty() || count < 2) {
+        for (int i = 0; i < count; i++) task(i);
+        return;
+    }
+    Job job{&task, count};
+    std::unique_lock lock(mutex);
+    jobs.push_back(&job);
+    wake.notify_all();
+    while (step(lock, job)) {}
+    finished.wait(lock, [&] { return job.done == job.count; });
+}
+
+void TaskPool::work() {
+    std::unique_lock lock(mutex);
+    for (;;) {
+        wake.wait(lock, [&] { return stopping || !jobs.empty(); });
+        if (stopping) return;
+        step(lock, *jobs.front());
+    }
+}
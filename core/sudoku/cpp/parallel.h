@@ -0,0 +1,44 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Small fixed pool for the opt-in parallel solve of single hard puzzles
+// (BasicSudokuSolver::setParallel). run() hands out task indices to the
+// workers and the calling thread and returns when all are done. Calls may
+// nest: a task can run() again, and the caller always works through its
+// own tasks, so a busy pool never blocks it.
+class TaskPool {
+public:
+    // threads counts the caller; 0 means one per hardware thread
+    explicit TaskPool(int threads = 0);
+    ~TaskPool();
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator=(const TaskPool&) = delete;
+
+    int size() const { return int(workers.size()) + 1; }
+
+    // task(i) for every i in [0, count)
+    void run(int count, const std::function<void(int)>& task);
+
+private:
+    struct Job {
+        const std::function<void(int)>* task;
+        int count;
+        int next = 0;
+        int done = 0;
+    };
+
+    void work();
+    // Claim and run one task of a job; false when none are left to claim
+    bool step(std::unique_lock<std::mutex>& lock, Job& job);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable wake, finished;
+    std::deque<Job*> jobs;   // jobs with unclaimed tasks, oldest first
+    bool stopping = false;
+};
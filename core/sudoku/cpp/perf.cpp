@@ -0,0 +1,93 @@
+#include "perf.h"
+#include <cerrno>
+#include <cstring>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+const char* PerfCounters::event_names[EVENT_COUNT] = {
+    "cycles", "instructions", "branch-misses", "L1d-misses", "LLC-misses"
+};
+
+#ifdef __linux__
+
+namespace {
+
+perf_event_attr eventAttr(PerfCounters::Event e) {
+    perf_event_attr attr{};
+    attr.size = sizeof(attr);
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+    auto cache = [&](uint64_t id) {
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = id | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    };
+    switch (e) {
+        case PerfCounters::CYCLES:        attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+        case PerfCounters::INSTRUCTIONS:  attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+        case PerfCounters::BRANCH_MISSES: attr.type = PERF_TYPE_HARDWARE; attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+        case PerfCounters::L1D_MISSES:    cache(PERF_COUNT_HW_CACHE_L1D); break;
+        case PerfCounters::LLC_MISSES:    cache(PERF_COUNT_HW_CACHE_LL); break;
+        default: break;
+    }
+    return attr;
+}
+
+} // namespace
+
+PerfCounters::PerfCounters() {
+    fd.fill(-1);
+    slot.fill(-1);
+    for (int e = 0; e < EVENT_COUNT; e++) {
+        perf_event_attr attr = eventAttr(Event(e));
+        fd[e] = syscall(SYS_perf_event_open, &attr, 0, -1, leader, 0);
+        if (fd[e] < 0) {
+            if (reason.empty()) reason = std::string(event_names[e]) + ": " + std::strerror(errno);
+            continue;
+        }
+        if (leader < 0) leader = fd[e];
+        slot[e] = opened++;
+    }
+    if (leader >= 0) {
+        ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+    }
+}
+
+PerfCounters::~PerfCounters() {
+    for (int f : fd)
+        if (f >= 0) close(f);
+}
+
+PerfCounters::Reading PerfCounters::read() const {
+    Reading reading;
+    if (leader < 0) return reading;
+    // nr, time_enabled, time_running, then one value per group member
+    uint64_t buf[3 + EVENT_COUNT] = {};
+    if (::read(leader, buf, sizeof(buf)) < 0) return reading;
+    reading.enabled = buf[1];
+    reading.running = buf[2];
+    for (int e = 0; e < EVENT_COUNT; e++)
+        if (slot[e] >= 0 && slot[e] < int(buf[0])) reading.values[e] = buf[3 + slot[e]];
+    return reading;
+}
+
+#else
+
+PerfCounters::PerfCounters() : reason("perf_event_open is Linux only") {
+    fd.fill(-1);
+    slot.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {}
+
+PerfCounters::Reading PerfCounters::read() const { return {}; }
+
+#endif
@@ -0,0 +1,40 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+
+// Hardware performance counters for the calling thread via perf_event_open
+// (Linux only). Events are opened as one group so a single read returns
+// them all. Events the kernel refuses (no PMU in a VM, perf_event_paranoid,
+// seccomp) are left out and read as zero, so callers just check available().
+class PerfCounters {
+public:
+    enum Event { CYCLES, INSTRUCTIONS, BRANCH_MISSES, L1D_MISSES, LLC_MISSES, EVENT_COUNT };
+    static const char* event_names[EVENT_COUNT];
+    using Values = std::array<uint64_t, EVENT_COUNT>;
+
+    PerfCounters();
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available(Event e) const { return slot[e] >= 0; }
+    bool any() const { return leader >= 0; }
+    const std::string& error() const { return reason; }   // why events are missing
+
+    // Running totals since construction. The group counted for `running`
+    // of the `enabled` nanoseconds: less means the kernel multiplexed it
+    // with other events, zero that it was never scheduled.
+    struct Reading {
+        Values values{};
+        uint64_t enabled = 0, running = 0;
+    };
+    Reading read() const;
+
+private:
+    int leader = -1;
+    int opened = 0;
+    std::array<int, EVENT_COUNT> fd;
+    std::array<int, EVENT_COUNT> slot;   // position in the group read, -1 if unavailable
+    std::string reason;
+};
@@ -1,36 +1,234 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
 #include "solver.h"
+#include "trace.h"
+#include <algorithm>
+#include <map>
+#include <memory>
+#include <optional>
 
 namespace py = pybind11;
 
-PYBIND11_MODULE(hsolve, m) {
-    m.doc() = "Sudoku Solver with advanced techniques";
+// Pool for threads > 1, kept between calls and resized on request
+TaskPool* sharedPool(int threads) {
+    static std::unique_ptr<TaskPool> pool;
+    if (threads == 1) return nullptr;
+    if (!pool || (threads && pool->size() != threads)) pool = std::make_unique<TaskPool>(threads);
+    return pool.get();
+}
 
-    m.def("hsolve", [](const std::string& puzzle, bool return_grid = false) -> py::object {
-        SudokuSolver solver(puzzle);
-        solver.solve();
-        
-        auto grid = solver.getGrid();
-        auto tech_count = solver.getTechCount();
-        
-        // Build stats vector
-        auto val = [&](int id){ return tech_count.contains(id) ? tech_count.at(id) : 0; };
-        std::vector<int> stats = {
-            int(isFilled(grid)), val(4), val(5), val(6), 
-            val(8), val(12), val(15), val(16), val(17)
-        };
-        
+// Tiered: the singles kernel first, the full engine only when it can't finish
+template<typename Geo>
+py::object solve(const std::string& puzzle, bool return_grid, int threads) {
+    SinglesKernel<Geo> kernel(puzzle);
+    if (kernel.run()) {
+        std::vector<int> stats = {1, 0, 0, 0, 0, 0, 0, 0, 0};
         if (return_grid) {
-            return py::make_tuple(stats, grid);
+            return py::make_tuple(stats, kernel.getGrid());
         }
         return py::cast(stats);
+    }
+
+    BasicSudokuSolver<Geo> solver = kernel.contradiction() ? BasicSudokuSolver<Geo>(puzzle)
+                                                           : BasicSudokuSolver<Geo>(kernel);
+    solver.setParallel(sharedPool(threads));
+    solver.solve();
+    
+    auto grid = solver.getGrid();
+    auto tech_count = solver.getTechCount();
+    
+    // Build stats vector
+    auto val = [&](int id){ return tech_count.contains(id) ? tech_count.at(id) : 0; };
+    std::vector<int> stats = {
+        int(isFilled(grid)), val(4), val(5), val(6), 
+        val(8), val(12), val(15), val(16), val(17)
+    };
+    
+    if (return_grid) {
+        return py::make_tuple(stats, grid);
+    }
+    return py::cast(stats);
+}
+
+// Chrome Trace Event JSON of one tiered solve
+template<typename Geo>
+std::string trace(const std::string& puzzle) {
+    TraceRecorder recorder;
+    recorder.beginPuzzle(puzzle);
+    recorder.beginKernel();
+    SinglesKernel<Geo> kernel(puzzle);
+    bool finished = kernel.run();
+    recorder.endKernel(finished, kernel.nakedSingles, kernel.hiddenSingles);
+    if (!finished) {
+        BasicSudokuSolver<Geo> solver = kernel.contradiction() ? BasicSudokuSolver<Geo>(puzzle)
+                                                               : BasicSudokuSolver<Geo>(kernel);
+        solver.solve(&recorder);
+        finished = isFilled(solver.getGrid());
+    }
+    recorder.endPuzzle(finished);
+    return recorder.json();
+}
+
+Schedule toSchedule(const std::vector<std::string>& steps) {
+    Schedule schedule;
+    std::string error;
+    if (!schedule.assign(steps, error)) throw py::value_error(error);
+    return schedule;
+}
+
+template<typename Geo>
+struct SolverSnapshot {
+    typename BasicSudokuSolver<Geo>::Snapshot state;
+};
+
+// Solver objects with snapshot and fork, for comparing technique sets
+// from a shared prefix
+template<typename Geo>
+void bindSolver(py::module_& m, const std::string& name) {
+    using Solver = BasicSudokuSolver<Geo>;
+    py::class_<SolverSnapshot<Geo>>(m, (name + "Snapshot").c_str())
+        .def("fork", [](const SolverSnapshot<Geo>& s) { return Solver::fork(s.state); },
+             "New solver starting from this snapshot");
+
+    py::class_<Solver>(m, name.c_str())
+        .def(py::init([](const std::string& puzzle) {
+            if (puzzle.size() != size_t(Geo::NN)) throw py::value_error("puzzle must have " + std::to_string(Geo::NN) + " characters");
+            return Solver(puzzle);
+        }), py::arg("puzzle"))
+        .def("solve", [](Solver& s, std::optional<std::vector<std::string>> steps) {
+            if (steps) {
+                const Schedule schedule = toSchedule(*steps);
+                s.solve(nullptr, &schedule);
+            } else {
+                s.solve();
+            }
+        }, py::arg("steps") = py::none(),
+           "Apply techniques to a fixpoint; steps (names from step_names) restricts and orders them")
+        .def("snapshot", [](const Solver& s) { return SolverSnapshot<Geo>{s.snapshot()}; },
+             "Immutable checkpoint of the current state")
+        .def("fork", [](const Solver& s) { return s.fork(); }, "Independent copy of the current state")
+        .def("backdoor", [](const Solver& s, const std::vector<std::vector<int>>& solution, int max_size,
+                            std::optional<std::vector<std::string>> steps) {
+            if (solution.size() != size_t(Geo::N) ||
+                std::any_of(solution.begin(), solution.end(), [](const auto& row) { return row.size() != size_t(Geo::N); }))
+                throw py::value_error("solution must be a " + std::to_string(Geo::N) + "x" + std::to_string(Geo::N) + " grid");
+            const Schedule schedule = steps ? toSchedule(*steps) : Schedule();
+            return s.findBackdoor(solution, max_size, &schedule).cells;
+        }, py::arg("solution"), py::arg("max_size") = 2, py::arg("steps") = py::none(),
+           "Fewest unsolved cells (indexes) whose values from solution let the techniques finish "
+           "from this state; empty if more than max_size are needed (see count_solutions)")
+        .def_property_readonly("grid", &Solver::getGrid)
+        .def_property_readonly("is_filled", [](const Solver& s) { return isFilled(s.getGrid()); })
+        .def_property_readonly("is_solved", [](const Solver& s) { return isFilled(s.getGrid()) && isValid(s.getGrid()); })
+        .def_property_readonly("hardest_step", [](const Solver& s) { return s.getProgress().hardestStep; })
+        .def_property_readonly("tech_count", [](const Solver& s) {
+            std::map<std::string, int> counts;
+            for (auto [id, cnt] : s.getTechCount()) counts[SolverBase::tech_names[id]] = cnt;
+            return counts;
+        });
+}
+
+// Which technique configurations solve a puzzle. Steps shared by every
+// configuration run once; each configuration then continues from a fork.
+template<typename Geo>
+std::vector<bool> solvesWith(const std::string& puzzle, const std::vector<std::vector<std::string>>& configs) {
+    std::vector<Schedule> schedules;
+    for (const auto& steps : configs) schedules.push_back(toSchedule(steps));
+
+    Schedule shared;
+    std::erase_if(shared.order, [&](int id) {
+        return std::any_of(schedules.begin(), schedules.end(), [&](const Schedule& s) {
+            return std::find(s.order.begin(), s.order.end(), id) == s.order.end();
+        });
+    });
+    BasicSudokuSolver<Geo> prefix(puzzle);
+    prefix.solve(nullptr, &shared);
+    const auto snapshot = prefix.snapshot();
+
+    std::vector<bool> solved;
+    for (const auto& schedule : schedules) {
+        auto solver = BasicSudokuSolver<Geo>::fork(snapshot);
+        solver.solve(nullptr, &schedule);
+        solved.push_back(isFilled(solver.getGrid()) && isValid(solver.getGrid()));
+    }
+    return solved;
+}
+
+PYBIND11_MODULE(hsolve, m) {
+    m.doc() = "Sudoku Solver with advanced techniques";
+
+    m.def("hsolve", [](const std::string& puzzle, bool return_grid, int threads) -> py::object {
+        // The board size follows from the puzzle length
+        switch (puzzle.size()) {
+            case 16:  return solve<Geometry<2, 2>>(puzzle, return_grid, threads);
+            case 81:  return solve<Geometry<3, 3>>(puzzle, return_grid, threads);
+            case 256: return solve<Geometry<4, 4>>(puzzle, return_grid, threads);
+            case 625: return solve<Geometry<5, 5>>(puzzle, return_grid, threads);
+        }
+        throw py::value_error("puzzle must have 16, 81, 256 or 625 characters");
     }, 
     py::arg("puzzle"), 
     py::arg("return_grid") = false,
+    py::arg("threads") = 1,
     "Solve sudoku and return stats list (is_filled, naked_pair, hidden_pair, naked_triple, "
-    "naked_quad, x_wing, y_wing, rectangle_elim, xyz_wing) or tuple (stats, grid) if return_grid=True");
+    "naked_quad, x_wing, y_wing, rectangle_elim, xyz_wing) or tuple (stats, grid) if return_grid=True. "
+    "threads > 1 (0: all cores) evaluates the expensive techniques in parallel, with the same result");
     
+    m.def("trace", [](const std::string& puzzle) {
+        switch (puzzle.size()) {
+            case 16:  return trace<Geometry<2, 2>>(puzzle);
+            case 81:  return trace<Geometry<3, 3>>(puzzle);
+            case 256: return trace<Geometry<4, 4>>(puzzle);
+            case 625: return trace<Geometry<5, 5>>(puzzle);
+        }
+        throw py::value_error("puzzle must have 16, 81, 256 or 625 characters");
+    },
+    py::arg("puzzle"),
+    "Solve sudoku and return a Chrome Trace Event JSON string (chrome://tracing, ui.perfetto.dev) "
+    "with a span per technique step");
+
+    m.attr("step_names") = std::vector<std::string>(std::begin(SolverBase::step_names), std::end(SolverBase::step_names));
+    bindSolver<Geometry<2, 2>>(m, "Solver4");
+    bindSolver<Geometry<3, 3>>(m, "Solver");
+    bindSolver<Geometry<4, 4>>(m, "Solver16");
+    bindSolver<Geometry<5, 5>>(m, "Solver25");
+
+    m.def("solves_with", [](const std::string& puzzle, const std::vector<std::vector<std::string>>& configs) {
+        switch (puzzle.size()) {
+            case 16:  return solvesWith<Geometry<2, 2>>(puzzle, configs);
+            case 81:  return solvesWith<Geometry<3, 3>>(puzzle, configs);
+            case 256: return solvesWith<Geometry<4, 4>>(puzzle, configs);
+            case 625: return solvesWith<Geometry<5, 5>>(puzzle, configs);
+        }
+        throw py::value_error("puzzle must have 16, 81, 256 or 625 characters");
+    },
+    py::arg("puzzle"), py::arg("configs"),
+    "For each technique configuration (a list of step names), whether it solves the puzzle. "
+    "Steps common to all configurations are applied once and shared through a snapshot");
+
+    m.def("analyze_clues", [](const std::string& puzzle) {
+        if (puzzle.size() != 16 && puzzle.size() != 81 && puzzle.size() != 256 && puzzle.size() != 625)
+            throw py::value_error("puzzle must have 16, 81, 256 or 625 characters");
+        const ClueAnalysis a = analyzeClues(puzzle);
+        py::dict d;
+        d["solutions"] = a.solutions;
+        d["clues"] = a.clues;
+        d["redundant"] = a.redundant;
+        d["minimal"] = a.minimal();
+        return d;
+    },
+    py::arg("puzzle"),
+    "Count solutions (0, 1, or 2 for two or more) and, for a unique puzzle, list the clue cells "
+    "whose removal keeps the solution unique; the puzzle is minimal when there are none");
+
+    m.def("count_solutions", [](const std::string& puzzle) {
+        std::vector<std::vector<int>> solution;
+        const int count = countSolutions(puzzle, &solution);
+        return py::make_tuple(count, count ? py::cast(solution) : py::none());
+    },
+    py::arg("puzzle"),
+    "Number of solutions (0, 1, or 2 for two or more) and the first one found as a grid, or None");
+
     // Utility functions
     m.def("is_valid", &isValid, py::arg("grid"),
           "Check if grid satisfies sudoku constraints");
@@ -0,0 +1,122 @@
+#include "results.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <format>
+#include <iterator>
+
+namespace {
+
+const char* error_names[] = {"", "empty_candidates", "wrong_solution"};
+
+// Column names for CSV and JSON keys: lower case, spaces and dashes as underscores
+std::string key(const char* name) {
+    std::string k(name);
+    for (char& ch : k) {
+        if (ch == ' ' || ch == '-') ch = '_';
+        else if (ch >= 'A' && ch <= 'Z') ch = char(ch - 'A' + 'a');
+    }
+    return k;
+}
+
+const std::array<std::string, SolverBase::TECH_COUNT> tech_keys = [] {
+    std::array<std::string, SolverBase::TECH_COUNT> keys;
+    for (int id = 0; id < SolverBase::TECH_COUNT; id++) keys[id] = key(SolverBase::tech_names[id]);
+    return keys;
+}();
+
+} // namespace
+
+bool ResultWriter::parseFormat(const std::string& name, Format& format) {
+    if (name == "jsonl") format = JSONL;
+    else if (name == "csv") format = CSV;
+    else if (name == "bin") format = BINARY;
+    else return false;
+    return true;
+}
+
+ResultWriter::ResultWriter(std::ostream& out, Format format, bool header) : out(out), format(format) {
+    buffer.reserve(BUFFER_SIZE + 4096);
+    if (!header) return;
+    if (format == CSV) {
+        buffer += "id,filled,solved,error,rating,seconds";
+        for (int id = 1; id < SolverBase::TECH_COUNT; id++) {
+            buffer += ',';
+            buffer += tech_keys[id];
+        }
+        buffer += ",solutions,redundant,backdoor_size,backdoor\n";
+    } else if (format == BINARY) {
+        buffer += "SDKR";
+        put<uint32_t>(BINARY_VERSION);
+        put<uint32_t>(SolverBase::TECH_COUNT);
+        put<uint32_t>(RECORD_SIZE);
+    }
+}
+
+template<typename T>
+void ResultWriter::put(T value) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &value, sizeof(T));
+    if constexpr (std::endian::native == std::endian::big) std::reverse(bytes, bytes + sizeof(T));
+    buffer.append(bytes, sizeof(T));
+}
+
+void ResultWriter::write(const PuzzleResult& r) {
+    auto inserter = std::back_inserter(buffer);
+    switch (format) {
+        case JSONL:
+            std::format_to(inserter, R"({{"id": {}, "filled": {}, "solved": {}, "error": "{}", "rating": {}, "seconds": {:.6f}, )",
+                           r.id, r.filled, r.solved, error_names[r.error], int(r.rating), r.nanos * 1e-9);
+            if (r.solutions >= 0) {
+                std::format_to(inserter, R"("solutions": {}, "redundant": [)", int(r.solutions));
+                for (size_t i = 0; i < r.redundant.size(); i++) std::format_to(inserter, "{}{}", i ? ", " : "", r.redundant[i]);
+                buffer += "], ";
+            }
+            if (r.backdoor >= 0) {
+                std::format_to(inserter, R"("backdoor_size": {}, "backdoor": [)", int(r.backdoor));
+                for (size_t i = 0; i < r.backdoorCells.size(); i++) std::format_to(inserter, "{}{}", i ? ", " : "", r.backdoorCells[i]);
+                buffer += "], ";
+            }
+            buffer += R"("techniques": {)";
+            // Only techniques that were used, to keep rows short
+            for (int id = 1, first = 1; id < SolverBase::TECH_COUNT; id++) {
+                if (!r.techCount[id]) continue;
+                std::format_to(inserter, R"({}"{}": {})", first ? "" : ", ", tech_keys[id], r.techCount[id]);
+                first = 0;
+            }
+            buffer += "}}\n";
+            break;
+        case CSV:
+            std::format_to(inserter, "{},{},{},{},{},{:.6f}", r.id, int(r.filled), int(r.solved),
+                           error_names[r.error], int(r.rating), r.nanos * 1e-9);
+            for (int id = 1; id < SolverBase::TECH_COUNT; id++) std::format_to(inserter, ",{}", r.techCount[id]);
+            // Redundant clue cells are space separated within one field
+            if (r.solutions >= 0) std::format_to(inserter, ",{},", int(r.solutions));
+            else buffer += ",,";
+            for (size_t i = 0; i < r.redundant.size(); i++) std::format_to(inserter, "{}{}", i ? " " : "", r.redundant[i]);
+            if (r.backdoor >= 0) std::format_to(inserter, ",{},", int(r.backdoor));
+            else buffer += ",,";
+            for (size_t i = 0; i < r.backdoorCells.size(); i++) std::format_to(inserter, "{}{}", i ? " " : "", r.backdoorCells[i]);
+            buffer += '\n';
+            break;
+        case BINARY:
+            put<uint64_t>(r.id);
+            put<uint8_t>(uint8_t(r.filled) | uint8_t(r.solved) << 1 |
+                         (r.solutions >= 0 ? uint8_t(4 | r.solutions << 3) : uint8_t(0)));
+            put<uint8_t>(r.error);
+            put<int8_t>(r.rating);
+            put<uint8_t>(uint8_t(std::min<size_t>(r.redundant.size(), 255)));
+            put<uint8_t>(uint8_t(r.backdoor));
+            put<uint8_t>(0);
+            put<uint16_t>(0);
+            put<uint64_t>(r.nanos);
+            for (uint32_t count : r.techCount) put<uint32_t>(count);
+            break;
+    }
+    if (buffer.size() >= BUFFER_SIZE) flush();
+}
+
+void ResultWriter::flush() {
+    out.write(buffer.data(), buffer.size());
+    buffer.clear();
+}
@@ -0,0 +1,58 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "solver.h"
+
+// One graded puzzle, as streamed by bsolver --out
+struct PuzzleResult {
+    enum Error : uint8_t { NONE, EMPTY_CANDIDATES, WRONG_SOLUTION };
+
+    uint64_t id = 0;          // 0-based line number in the input file
+    bool filled = false;
+    bool solved = false;
+    Error error = NONE;
+    int8_t rating = -1;       // hardest step that made progress (step_names index), -1 for none
+    uint64_t nanos = 0;       // solve time
+    std::array<uint32_t, SolverBase::TECH_COUNT> techCount{};
+    int8_t solutions = -1;    // with --minimality: 0, 1 or 2 (two or more); -1 when not analyzed
+    std::vector<int> redundant;   // with --minimality: clue cells removable without losing uniqueness
+    int8_t backdoor = -1;     // with --backdoor: cells needed by a stalled solve, 0 if over the cap; -1 when not analyzed
+    std::vector<int> backdoorCells;
+};
+
+// Buffered writer for per-puzzle rows. Rows are formatted into a fixed
+// buffer that is flushed whenever it fills, so memory does not grow with
+// the corpus.
+//
+// BINARY is a 16-byte header ("SDKR", then u32 version, technique count
+// and record size) followed by fixed-width little-endian records:
+//   u64 id, u8 flags (bit 0 filled, bit 1 solved, bit 2 clues analyzed,
+//   bits 3-4 solution count), u8 error, i8 rating, u8 redundant clue
+//   count, u8 backdoor size (255 not analyzed), 3 reserved bytes,
+//   u64 nanoseconds, u32 count per technique id.
+class ResultWriter {
+public:
+    enum Format { JSONL, CSV, BINARY };
+    static bool parseFormat(const std::string& name, Format& format);
+
+    static constexpr uint32_t BINARY_VERSION = 6;
+    static constexpr uint32_t RECORD_SIZE = 8 + 8 + 8 + 4 * SolverBase::TECH_COUNT;
+
+    // header = false when appending to a file that already has one
+    ResultWriter(std::ostream& out, Format format, bool header = true);
+    ~ResultWriter() { flush(); }
+
+    void write(const PuzzleResult& r);
+    void flush();
+
+private:
+    static constexpr size_t BUFFER_SIZE = 1 << 16;
+    template<typename T> void put(T value);
+
+    std::ostream& out;
+    Format format;
+    std::string buffer;
+};
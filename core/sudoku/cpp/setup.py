@@ -10,6 +10,15 @@ ext_modules = [
             "tech_base.cpp",
             "tech_wing.cpp",
             "tech_recelim.cpp",
+            "tech_coloring.cpp",
+            "tech_unique.cpp",
+            "tech_chains.cpp",
+            "tech_als.cpp",
+            "tech_loops.cpp",
+            "bitslice.cpp",
+            "singles.cpp",
+            "parallel.cpp",
+            "trace.cpp",
             "utils.cpp"
         ],
         include_dirs=[pybind11.get_include(), ".", "/usr/include/c++/13", "/usr/include/x86_64-linux-gnu/c++/13"],
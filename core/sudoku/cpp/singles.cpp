@@ -0,0 +1,111 @@
+#include "singles.h"
+#include <bit>
+
+template<typename Geo>
+SinglesKernel<Geo>::SinglesKernel(const std::string& input) {
+    const auto& geo = Geo::get();
+    pending.reserve(Geo::NN);
+
+    // Givens first, so every empty cell starts from its final basic mask
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        int n = Geo::fromChar(input[cell]);
+        if (n == 0 || n > N) continue;
+        const Word bit = Word(1) << n;
+        for (int h : geo.houseOf[cell]) {
+            if (placed[h] & bit) failed = true;
+            placed[h] |= bit;
+        }
+        values[cell] = n;
+        cand[cell] = bit;
+        unsolved--;
+    }
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        if (values[cell]) continue;
+        const auto& h = geo.houseOf[cell];
+        cand[cell] = DIGITS & ~(placed[h[0]] | placed[h[1]] | placed[h[2]]);
+        if (std::popcount(cand[cell]) <= 1) pending.push_back(cell);
+    }
+}
+
+// Set cell to n and remove n from its peers, queueing new naked singles
+template<typename Geo>
+void SinglesKernel<Geo>::place(int cell, int n) {
+    const auto& geo = Geo::get();
+    const Word bit = Word(1) << n;
+    if (values[cell] || !(cand[cell] & bit)) {
+        failed = true;
+        return;
+    }
+    values[cell] = n;
+    cand[cell] = bit;
+    unsolved--;
+    for (int h : geo.houseOf[cell]) placed[h] |= bit;
+
+    for (int peer : geo.peers[cell]) {
+        if (values[peer] || !(cand[peer] & bit)) continue;
+        cand[peer] &= ~bit;
+        if (std::popcount(cand[peer]) <= 1) pending.push_back(peer);
+    }
+}
+
+template<typename Geo>
+void SinglesKernel<Geo>::drain() {
+    while (!pending.empty() && !failed) {
+        int cell = pending.back();
+        pending.pop_back();
+        if (values[cell]) continue;
+        if (cand[cell] == 0) {
+            failed = true;
+            return;
+        }
+        place(cell, std::countr_zero(cand[cell]));
+        nakedSingles++;
+    }
+}
+
+template<typename Geo>
+bool SinglesKernel<Geo>::run() {
+    const auto& geo = Geo::get();
+    bool changed = true;
+    while (changed && !failed && unsolved) {
+        changed = false;
+        drain();
+
+        // Hidden singles: digits seen exactly once among a house's empty cells
+        for (int h = 0; h < Geo::HOUSES && !failed; h++) {
+            Word once = 0, twice = 0;
+            for (int cell : geo.houseCells[h]) {
+                if (values[cell]) continue;
+                twice |= once & cand[cell];
+                once |= cand[cell];
+            }
+            const Word open = DIGITS & ~placed[h];
+            if ((once & open) != open) {
+                failed = true;   // a digit with no place left
+                break;
+            }
+            for (Word hidden = once & ~twice & open; hidden && !failed; hidden &= hidden - 1) {
+                const int n = std::countr_zero(hidden);
+                if (placed[h] >> n & 1) continue;   // placed by an earlier single
+                for (int cell : geo.houseCells[h]) {
+                    if (values[cell] || !(cand[cell] >> n & 1)) continue;
+                    place(cell, n);
+                    hiddenSingles++;
+                    break;
+                }
+                drain();
+                changed = true;
+            }
+        }
+    }
+    return solved();
+}
+
+template<typename Geo>
+std::vector<std::vector<int>> SinglesKernel<Geo>::getGrid() const {
+    std::vector<std::vector<int>> grid(N, std::vector<int>(N));
+    for (int cell = 0; cell < Geo::NN; cell++) grid[cell / N][cell % N] = values[cell];
+    return grid;
+}
+
+SUDOKU_INSTANTIATE(SinglesKernel)
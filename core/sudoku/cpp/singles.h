@@ -0,0 +1,50 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "geometry.h"
+
+// First tier of the grading pipeline: naked and hidden singles only, on
+// flat candidate words with a work stack. Most corpus puzzles are finished
+// here; the rest are handed to the full solver with their state (see the
+// BasicSudokuSolver constructor taking a kernel). Singles propagation is
+// confluent, so the full solver resumes from exactly the board its own
+// singles steps would have reached.
+template<typename Geo>
+class SinglesKernel {
+public:
+    static constexpr int N = Geo::N;
+    using Word = typename Geo::Word;
+    static constexpr Word DIGITS = Word(Geo::Mask::ALL & ~Word(1));   // bits 1..N
+
+    explicit SinglesKernel(const std::string& input);
+
+    // Propagate to a fixpoint. Returns true when the board is solved.
+    bool run();
+
+    bool solved() const { return unsolved == 0 && !failed; }
+    bool contradiction() const { return failed; }
+    int value(int cell) const { return values[cell]; }
+    Word candidates(int cell) const { return values[cell] ? Word(0) : cand[cell]; }
+    std::vector<std::vector<int>> getGrid() const;
+
+    int nakedSingles = 0;
+    int hiddenSingles = 0;
+
+private:
+    void place(int cell, int n);
+    void drain();
+
+    std::array<Word, Geo::NN> cand{};
+    std::array<uint8_t, Geo::NN> values{};
+    std::array<Word, Geo::HOUSES> placed{};   // digits placed in each house
+    std::vector<int> pending;                 // cells that became naked singles
+    int unsolved = Geo::NN;
+    bool failed = false;
+};
+
+extern template class SinglesKernel<Geometry<2, 2>>;
+extern template class SinglesKernel<Geometry<3, 3>>;
+extern template class SinglesKernel<Geometry<4, 4>>;
+extern template class SinglesKernel<Geometry<5, 5>>;
@@ -1,80 +1,301 @@
 #include "solver.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
+#include <atomic>
+#include <optional>
 
-const char* SudokuSolver::tech_names[26] = {"", 
+const char* SolverBase::tech_names[TECH_COUNT] = {"", 
     "Basic Elimination", "Naked Single", "Hidden Single",
     "Naked Pair", "Hidden Pair", "Naked Triple", "Hidden Triple", "Naked Quad", "Hidden Quad", "Pointing Pairs", "Box-Line Reduction",
     "X-Wing", "Chute Remote Pairs", "Swordfish", "Y-Wing", "Rectangle Elimination", "XYZ-Wing", 
-    "Jellyfish", "Simple Coloring", "X-Cycles", "Single Coloring", "X-Chain", "XY-Chain", "Discontinuous Nice Loop", "Continuous Nice Loop"
+    "Jellyfish", "Simple Coloring", "X-Cycles", "Single Coloring", "X-Chain", "XY-Chain", "Discontinuous Nice Loop", "Continuous Nice Loop",
+    "W-Wing", "WXYZ-Wing", "AIC", "Digit Forcing Chain", "Cell Forcing Chain", "Unit Forcing Chain",
+    "Unique Rectangle Type 1", "Unique Rectangle Type 2", "Unique Rectangle Type 3", "Unique Rectangle Type 4",
+    "Hidden Unique Rectangle", "Bivalue Universal Grave", "ALS-XZ", "ALS-XY-Wing"
 };
 
-SudokuSolver::SudokuSolver(const std::string& input) : grid(9, std::vector<int>(9)), 
-                                                       candidates(9, std::vector<std::bitset<10>>(9)),
-                                                       rows(9), cols(9), boxes(9) {
+template<typename Geo>
+auto BasicSudokuSolver<Geo>::layout() -> const Layout& {
+    static const Layout shared = [] {
+        Layout l;
+        l.rows.resize(N);
+        l.cols.resize(N);
+        l.boxes.resize(N);
+        for (int r = 0; r < N; r++) {
+            for (int c = 0; c < N; c++) {
+                l.rows[r].cells.push_back({r, c});
+                l.cols[c].cells.push_back({r, c});
+                l.boxes[Geo::box(r, c)].cells.push_back({r, c});
+            }
+        }
+        return l;
+    }();
+    return shared;
+}
+
+template<typename Geo>
+BasicSudokuSolver<Geo>::BasicSudokuSolver(const std::string& input) : grid(N, std::vector<int>(N)),
+                                                                      candidates(N, std::vector<Mask>(N)) {
     // Parse input
-    for (int i = 0; i < 81; i++) {
-        grid[i/9][i%9] = input[i] - '0';
+    for (int i = 0; i < Geo::NN; i++) {
+        grid[i/N][i%N] = Geo::fromChar(input[i]);
     }
     
-    // Initialize candidates and groups
-    for (int r = 0; r < 9; r++) {
-        for (int c = 0; c < 9; c++) {
+    // Initialize candidates
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
             if (grid[r][c] == 0) {
                 candidates[r][c].set();
                 candidates[r][c][0] = 0;
             }
-            // Build group structures
-            rows[r].cells.push_back({r, c});
-            cols[c].cells.push_back({r, c});
-            boxes[(r/3)*3 + c/3].cells.push_back({r, c});
+            index.update(r * N + c, candidates[r][c].to_ulong());
         }
     }
     eliminateBasic();
 }
 
-void SudokuSolver::solve() {
+// Resume from the singles kernel: grid, candidates and singles counts carry over
+template<typename Geo>
+BasicSudokuSolver<Geo>::BasicSudokuSolver(const SinglesKernel<Geo>& kernel) : grid(N, std::vector<int>(N)),
+                                                                              candidates(N, std::vector<Mask>(N)) {
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
+            grid[r][c] = kernel.value(r * N + c);
+            candidates[r][c] = Mask(kernel.candidates(r * N + c));
+            index.update(r * N + c, kernel.candidates(r * N + c));
+        }
+    }
+    tech_count[BASIC_ELIM] = 1;
+    if (kernel.nakedSingles) tech_count[NAKED_SINGLE] = kernel.nakedSingles;
+    if (kernel.hiddenSingles) tech_count[HIDDEN_SINGLE] = kernel.hiddenSingles;
+}
+
+const char* SolverBase::step_names[STEP_COUNT] = {
+    "Basic Elimination", "Naked Singles", "Hidden Singles", "Naked Pairs", "Hidden Pairs",
+    "Naked Triples", "Intersection Removal", "X-Wing", "Y-Wing", "XYZ-Wing", "W-Wing",
+    "Rectangle Elimination", "Chute Remote Pairs", "Unique Rectangles", "Bivalue Universal Grave", "WXYZ-Wing",
+    "XY-Chain", "Single Coloring", "Naked Quads", "Nice Loops", "Almost Locked Sets"
+};
+
+Schedule::Schedule() {
+    for (int i = 0; i < SolverBase::STEP_COUNT; i++) order.push_back(i);
+}
+
+bool Schedule::assign(const std::vector<std::string>& names, std::string& error) {
+    std::vector<int> steps;
+    for (const auto& name : names) {
+        auto it = std::find(std::begin(SolverBase::step_names), std::end(SolverBase::step_names), name);
+        if (it == std::end(SolverBase::step_names)) {
+            error = std::format("unknown step \"{}\"", name);
+            return false;
+        }
+        const int id = it - std::begin(SolverBase::step_names);
+        if (std::find(steps.begin(), steps.end(), id) == steps.end()) steps.push_back(id);
+    }
+    order = steps;
+    return true;
+}
+
+bool Schedule::load(const std::string& path, std::string& error) {
+    std::ifstream in(path);
+    if (!in) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::vector<int> steps;
+    std::string line;
+    for (int lineNo = 1; std::getline(in, line); lineNo++) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        if (line.rfind("step ", 0) != 0) {
+            error = std::format("{}:{}: expected \"step <name>\"", path, lineNo);
+            return false;
+        }
+        const std::string name = line.substr(5);
+        auto it = std::find(std::begin(SolverBase::step_names), std::end(SolverBase::step_names), name);
+        if (it == std::end(SolverBase::step_names)) {
+            error = std::format("{}:{}: unknown step \"{}\"", path, lineNo, name);
+            return false;
+        }
+        const int id = it - std::begin(SolverBase::step_names);
+        if (std::find(steps.begin(), steps.end(), id) != steps.end()) {
+            error = std::format("{}:{}: step \"{}\" listed twice", path, lineNo, name);
+            return false;
+        }
+        steps.push_back(id);
+    }
+    order = steps;
+    return true;
+}
+
+bool Schedule::save(const std::string& path, const std::string& comment) const {
+    std::ofstream out(path);
+    out << "# bsolver schedule profile\n";
+    std::istringstream lines(comment);
+    for (std::string line; std::getline(lines, line);) out << "# " << line << "\n";
+    for (int id : order) out << "step " << SolverBase::step_names[id] << "\n";
+    return bool(out);
+}
+
+template<typename Geo>
+const typename BasicSudokuSolver<Geo>::Step BasicSudokuSolver<Geo>::steps[STEP_COUNT] = {
+    [](BasicSudokuSolver& s) { return s.eliminateBasic(); },
+    [](BasicSudokuSolver& s) { return s.checkNakedSingles(); },
+    [](BasicSudokuSolver& s) { return s.findHiddenSingles(); },
+    [](BasicSudokuSolver& s) { return s.findNakedSets(2, NAKED_PAIR); },
+    [](BasicSudokuSolver& s) { return s.findHiddenPairs(); },
+    [](BasicSudokuSolver& s) { return s.findNakedSets(3, NAKED_TRIPLE); },
+    [](BasicSudokuSolver& s) { return s.findIntersectionRemoval(); },
+    [](BasicSudokuSolver& s) { return s.findXWing(); },
+    // [](BasicSudokuSolver& s) { return s.findXChain(); },
+    [](BasicSudokuSolver& s) { return s.findYWing(); },
+    [](BasicSudokuSolver& s) { return s.findXYZWing(); },
+    [](BasicSudokuSolver& s) { return s.findWWing(); },
+    [](BasicSudokuSolver& s) { return s.findRectangleElimination(); },
+    [](BasicSudokuSolver& s) { return s.findChuteRemotePairs(); },
+    [](BasicSudokuSolver& s) { return s.findUniqueRectangles(); },
+    [](BasicSudokuSolver& s) { return s.findBivalueGrave(); },
+    [](BasicSudokuSolver& s) { return s.findWXYZWing(); },
+    [](BasicSudokuSolver& s) { return s.findXYChain(); },
+    [](BasicSudokuSolver& s) { return s.findSingleColoring(); },
+    [](BasicSudokuSolver& s) { return s.findNakedSets(4, NAKED_QUAD); },
+    [](BasicSudokuSolver& s) { return s.findNiceLoops(); },
+    [](BasicSudokuSolver& s) { return s.findAlmostLockedSets(); },
+    // [](BasicSudokuSolver& s) { return s.findSwordfish(); },
+    // [](BasicSudokuSolver& s) { return s.findJellyfish(); },
+    // [](BasicSudokuSolver& s) { return s.findHiddenTriples(); }, // long eval, not so impactful
+    // [](BasicSudokuSolver& s) { return s.findHiddenQuads(); }, // long eval, not so impactful
+    // [](BasicSudokuSolver& s) { return s.findSimpleColoring(); },
+    // [](BasicSudokuSolver& s) { return s.findXCycles(); },
+};
+
+template<typename Geo>
+void BasicSudokuSolver<Geo>::solve(SolveObserver* observer, const Schedule* schedule) {
+    const int count = schedule ? schedule->order.size() : STEP_COUNT;
     bool changed = true;
     while (changed) {
-        changed = eliminateBasic() 
-                  || checkNakedSingles()
-                  || findHiddenSingles()
-                  || findNakedSets(2, NAKED_PAIR)
-                  || findHiddenPairs()
-                  || findNakedSets(3, NAKED_TRIPLE)
-                  || findIntersectionRemoval()
-                  || findXWing()
-                  // || findXChain()
-                  || findYWing()
-                  || findXYChain()
-                  || findXYZWing()
-                  || findSingleColoring()
-                  || findNakedSets(4, NAKED_QUAD) 
-                  // || findNiceLoops()
-                  // || findRectangleElimination()
-                  // || findChuteRemotePairs() // not working ?
-                  // || findSwordfish()
-                  // || findJellyfish()
-                  // || findHiddenTriples() // long eval, not so impactful
-                  // || findHiddenQuads() // long eval, not so impactful
-                  // || findSimpleColoring()
-                  // || findXCycles()
-                  ;
+        changed = false;
+        for (int k = 0; k < count && !changed; k++) {
+            const int i = schedule ? schedule->order[k] : k;
+            if (speculative >> i & 1) {
+                int ids[STEP_COUNT], run = 0;
+                for (int j = k; j < count; j++) {
+                    const int id = schedule ? schedule->order[j] : j;
+                    if (!(speculative >> id & 1)) break;
+                    ids[run++] = id;
+                }
+                if (run > 1) {
+                    changed = speculate(ids, run, observer);
+                    k += run - 1;
+                    continue;
+                }
+            }
+            if (observer) observer->beginStep(i, progress);
+            changed = steps[i](*this);
+            if (changed && i > progress.hardestStep) progress.hardestStep = i;
+            if (observer) observer->endStep(i, changed, progress);
+        }
+    }
+}
+
+// Run the given steps at once on copies of the board and keep the copy of
+// the first that made progress; the others are dropped
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::speculate(const int* ids, int count, SolveObserver* observer) {
+    std::vector<std::optional<BasicSudokuSolver>> trials(count);
+    std::vector<char> changed(count);
+    pool->run(count, [&](int t) {
+        trials[t].emplace(*this);
+        changed[t] = steps[ids[t]](*trials[t]);
+    });
+
+    for (int t = 0; t < count; t++) {
+        if (observer) observer->beginStep(ids[t], progress);
+        if (changed[t]) {
+            *this = std::move(*trials[t]);
+            if (ids[t] > progress.hardestStep) progress.hardestStep = ids[t];
+        }
+        if (observer) observer->endStep(ids[t], changed[t], progress);
+        if (changed[t]) return true;
+    }
+    return false;
+}
+
+// Iterative deepening over sets of open cells. Within a size, a set is
+// extended from the solved state of its prefix, and the set with the
+// earliest first cell wins, so the result does not depend on the pool.
+// Each task works on one copy of the board and tries the extensions of a
+// prefix under checkpoints, so undoing one costs only the cells it changed.
+template<typename Geo>
+auto BasicSudokuSolver<Geo>::findBackdoor(const std::vector<std::vector<int>>& solution, int maxSize,
+                                          const Schedule* schedule) const -> Backdoor {
+    std::vector<int> open;
+    for (int cell = 0; cell < Geo::NN; cell++)
+        if (!grid[cell / N][cell % N]) open.push_back(cell);
+    const int count = int(open.size());
+
+    Backdoor result;
+    std::atomic<long> trials{0};
+    for (int size = 1; size <= maxSize && size <= count && result.cells.empty(); size++) {
+        std::atomic<int> winner{count};
+        std::vector<std::vector<int>> found(count);
+
+        // Place open[i] on `trial` and solve; true once some prefix finishes.
+        // Extensions are tried under a checkpoint and rolled back.
+        auto extend = [&](auto& self, BasicSudokuSolver& trial, int i, int left, int first,
+                          std::vector<int>& cells) -> bool {
+            if (winner < first) return false;
+            const int r = open[i] / N, c = open[i] % N;
+            trial.setCell(r, c, solution[r][c]);
+            trial.solve(nullptr, schedule);
+            trials++;
+            cells.push_back(open[i]);
+            if (isFilled(trial.grid)) return true;
+            for (int j = i + 1; j < count && left > 1; j++) {
+                if (trial.grid[open[j] / N][open[j] % N]) continue;
+                const size_t checkpoint = trial.mark();
+                const bool done = self(self, trial, j, left - 1, first, cells);
+                trial.rollback(checkpoint);
+                if (done) return true;
+            }
+            cells.pop_back();
+            return false;
+        };
+        auto task = [&](int i) {
+            BasicSudokuSolver trial = *this;
+            trial.setParallel(nullptr);
+            std::vector<int> cells;
+            if (!extend(extend, trial, i, size, i, cells)) return;
+            found[i] = std::move(cells);
+            for (int w = winner; i < w && !winner.compare_exchange_weak(w, i);) {}
+        };
+        if (pool) pool->run(count, task);
+        else for (int i = 0; i < count; i++) task(i);
+        if (winner < count) result.cells = std::move(found[winner]);
     }
+    result.trials = trials;
+    return result;
 }
 
-void SudokuSolver::printResults() const {
+template<typename Geo>
+void BasicSudokuSolver<Geo>::printResults() const {
     std::cout << "Used techniques:\n";
     for (const auto& [t, cnt] : tech_count) {
         std::cout << "- " << tech_names[t] << ": " << cnt << "\n";
     }
     
     std::cout << "\nFinal grid:\n";
-    for (int r = 0; r < 9; r++) {
-        if (r % 3 == 0 && r) std::cout << "------+-------+------\n";
-        for (int c = 0; c < 9; c++) {
-            if (c % 3 == 0 && c) std::cout << "| ";
-            std::cout << (grid[r][c] ? char('0' + grid[r][c]) : '.') << ' ';
+    for (int r = 0; r < N; r++) {
+        if (r % BR == 0 && r) {
+            for (int b = 0; b < BR; b++)
+                std::cout << (b ? "-+-" : "") << std::string(2 * BC - 1, '-');
+            std::cout << '\n';
+        }
+        for (int c = 0; c < N; c++) {
+            if (c % BC == 0 && c) std::cout << "| ";
+            std::cout << Geo::toChar(grid[r][c]) << ' ';
         }
         std::cout << '\n';
     }
@@ -82,10 +303,11 @@ void SudokuSolver::printResults() const {
     int filled = 0;
     for (const auto& row : grid)
         filled += std::count_if(row.begin(), row.end(), [](int x){ return x != 0; });
-    std::cout << "\nFilled: " << filled << "/81\n";
+    std::cout << "\nFilled: " << filled << "/" << Geo::NN << "\n";
 }
 
-void SudokuSolver::printCandidates() const {
+template<typename Geo>
+void BasicSudokuSolver<Geo>::printCandidates() const {
     std::cout << "Candidates:\n";
     for (size_t r = 0; r < candidates.size(); ++r) {
         for (size_t c = 0; c < candidates[r].size(); ++c) {
@@ -97,12 +319,53 @@ void SudokuSolver::printCandidates() const {
     }
 }
 
-void SudokuSolver::setCell(int r, int c, int n) {
+template<typename Geo>
+void BasicSudokuSolver<Geo>::setCell(int r, int c, int n) {
+    saveCell(r, c);
     grid[r][c] = n;
     candidates[r][c].reset();
+    index.update(r * N + c, 0);
+    progress.placed++;
     
     // Eliminate from all groups containing this cell
-    for (auto [rr, cc] : rows[r].cells) candidates[rr][cc][n] = 0;
-    for (auto [rr, cc] : cols[c].cells) candidates[rr][cc][n] = 0;
-    for (auto [rr, cc] : boxes[(r/3)*3 + c/3].cells) candidates[rr][cc][n] = 0;
-}
\ No newline at end of file
+    for (auto [rr, cc] : rows[r].cells) removeCandidate(rr, cc, n);
+    for (auto [rr, cc] : cols[c].cells) removeCandidate(rr, cc, n);
+    for (auto [rr, cc] : boxes[Geo::box(r, c)].cells) removeCandidate(rr, cc, n);
+}
+
+// Candidate bits 1-N per cell; solved cells hold only their value bit
+template<typename Geo>
+auto BasicSudokuSolver<Geo>::cellMasks() const -> std::array<Word, Geo::NN> {
+    std::array<Word, Geo::NN> masks{};
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        int r = cell / N, c = cell % N;
+        masks[cell] = grid[r][c] ? Word(Word(1) << grid[r][c]) : candidates[r][c].to_ulong();
+    }
+    return masks;
+}
+
+template<typename Geo>
+size_t BasicSudokuSolver<Geo>::mark() {
+    openMarks++;
+    return trail.size();
+}
+
+template<typename Geo>
+void BasicSudokuSolver<Geo>::rollback(size_t checkpoint) {
+    while (trail.size() > checkpoint) {
+        const auto& e = trail.back();
+        grid[e.cell / N][e.cell % N] = e.value;
+        candidates[e.cell / N][e.cell % N] = e.cands;
+        index.update(e.cell, e.cands.to_ulong());
+        trail.pop_back();
+    }
+    commit(checkpoint);
+}
+
+template<typename Geo>
+void BasicSudokuSolver<Geo>::commit(size_t /*checkpoint*/) {
+    // Entries stay on the trail while an outer checkpoint may still undo them
+    if (--openMarks == 0) trail.clear();
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
@@ -3,8 +3,13 @@
 #include <bitset>
 #include <map>
 #include <functional>
+#include <memory>
 #include <string>
 #include <format>
+#include "geometry.h"
+#include "singles.h"
+#include "candindex.h"
+#include "parallel.h"
 
 struct ChainLink {
     int fromCell;
@@ -14,44 +19,176 @@ struct ChainLink {
     bool isStrong;
 };
 
-class SudokuSolver {
+// Technique ids and names, shared by every board size
+class SolverBase {
 public:
-    static const char* tech_names[26];
+    static constexpr int TECH_COUNT = 40;
+    static const char* tech_names[TECH_COUNT];
+    static constexpr int STEP_COUNT = 21;
+    static const char* step_names[STEP_COUNT];
+    enum Tech {
+        BASIC_ELIM = 1, NAKED_SINGLE, HIDDEN_SINGLE, NAKED_PAIR, HIDDEN_PAIR,
+        NAKED_TRIPLE, HIDDEN_TRIPLE, NAKED_QUAD, HIDDEN_QUAD, POINTING_PAIRS, BOX_LINE,
+        X_WING, CHUTE_REMOTE_PAIR, SWORDFISH, Y_WING, RECTANGLE_ELIM, XYZ_WING, JELLYFISH,
+        SIMPLE_COLORING, X_CYCLE, SINGLE_COLORING, X_CHAIN, XY_CHAIN, DISCONTINUOUS_NICE_LOOP, CONTINUOUS_NICE_LOOP,
+        W_WING, WXYZ_WING, AIC, DIGIT_FORCING_CHAIN, CELL_FORCING_CHAIN, UNIT_FORCING_CHAIN,
+        UNIQUE_RECT_1, UNIQUE_RECT_2, UNIQUE_RECT_3, UNIQUE_RECT_4, HIDDEN_UNIQUE_RECT, BIVALUE_GRAVE,
+        ALS_XZ, ALS_XY_WING
+    };
+};
+
+// Running totals of board changes, for observers to take differences of
+struct SolveProgress {
+    long eliminated = 0;   // candidates removed
+    long placed = 0;       // cells set
+    int hardestStep = -1;  // highest step index that made progress
+};
+
+// Hooks around every technique step of solve(), for profiling and tracing.
+// `step` indexes SolverBase::step_names; `changed` is the step's result.
+class SolveObserver {
+public:
+    virtual ~SolveObserver() = default;
+    virtual void beginStep(int /*step*/, const SolveProgress& /*progress*/) {}
+    virtual void endStep(int /*step*/, bool /*changed*/, const SolveProgress& /*progress*/) {}
+};
+
+// Order in which solve() tries the technique steps, as indices into
+// SolverBase::step_names; steps left out are not run. Profiles are text
+// files with one "step <name>" line per step, as written by the autotuner.
+struct Schedule {
+    std::vector<int> order;
+
+    Schedule();   // every step, in table order
+    bool assign(const std::vector<std::string>& names, std::string& error);
+    bool load(const std::string& path, std::string& error);
+    bool save(const std::string& path, const std::string& comment) const;
+};
+
+// Solver for an N x N board described by Geo (see geometry.h). Members are
+// defined in the .cpp files and instantiated there for every supported size.
+template<typename Geo>
+class BasicSudokuSolver : public SolverBase {
+public:
+    static constexpr int N = Geo::N;
+    static constexpr int BR = Geo::BOX_ROWS;
+    static constexpr int BC = Geo::BOX_COLS;
+    using Mask = typename Geo::Mask;
+    using Word = typename Geo::Word;
+    using CellSet = typename Geo::CellSet;
 private:
     std::vector<std::vector<int>> grid;
-    std::vector<std::vector<std::bitset<10>>> candidates;
+    std::vector<std::vector<Mask>> candidates;
     std::map<int, int> tech_count;
+    SolveProgress progress;
+    CandidateIndex<Geo> index;   // kept in step by the candidate helpers below
+
+    // Undo log: previous state of every cell changed while a checkpoint is open
+    struct TrailEntry {
+        int cell;
+        int value;
+        Mask cands;
+    };
+    std::vector<TrailEntry> trail;
+    int openMarks = 0;
+
+    TaskPool* pool = nullptr;   // set by setParallel
+    uint32_t speculative = 0;   // step ids evaluated speculatively
 
 public:
-    explicit SudokuSolver(const std::string& input);
-    void solve();
+    explicit BasicSudokuSolver(const std::string& input);
+    explicit BasicSudokuSolver(const SinglesKernel<Geo>& kernel);
+    void solve(SolveObserver* observer = nullptr, const Schedule* schedule = nullptr);
     void printResults() const;
     void printCandidates() const;  // Debug helper
-private:
-    enum Tech {
-        BASIC_ELIM = 1, NAKED_SINGLE, HIDDEN_SINGLE, NAKED_PAIR, HIDDEN_PAIR,
-        NAKED_TRIPLE, HIDDEN_TRIPLE, NAKED_QUAD, HIDDEN_QUAD, POINTING_PAIRS, BOX_LINE,
-        X_WING, CHUTE_REMOTE_PAIR, SWORDFISH, Y_WING, RECTANGLE_ELIM, XYZ_WING, JELLYFISH, 
-        SIMPLE_COLORING, X_CYCLE, SINGLE_COLORING, X_CHAIN, XY_CHAIN, DISCONTINUOUS_NICE_LOOP, CONTINUOUS_NICE_LOOP
-    };
 
-    // Group structure for unified iteration
+    // Opt-in parallel solve for single hard puzzles. A run of consecutive
+    // steps from `steps` (bit i = step_names[i]) is evaluated concurrently,
+    // each on its own copy of the board, and the copy of the first one in
+    // order that made progress is kept, so the outcome equals the
+    // sequential solve. Per-digit and per-candidate searches fan out over
+    // the pool too. Observer hooks of such a run fire after it is decided.
+    // By default: WXYZ-Wing, XY-Chain, Single Coloring, Naked Quads,
+    // Nice Loops, Almost Locked Sets.
+    static constexpr uint32_t SPECULATIVE_STEPS = 0x3f << 15;
+    void setParallel(TaskPool* pool, uint32_t steps = SPECULATIVE_STEPS) {
+        this->pool = pool && pool->size() > 1 ? pool : nullptr;   // one thread: stay sequential
+        speculative = this->pool ? steps : 0;
+    }
+
+    // Checkpoints for trial placements, such as those of findBackdoor:
+    // board changes made after mark() are undone by rollback() or kept by
+    // commit(), in time proportional to the number of changes. Technique
+    // counts and progress are not restored. Checkpoints nest.
+    size_t mark();
+    void rollback(size_t checkpoint);
+    void commit(size_t checkpoint);
+
+    // Branch points for comparing technique configurations: solve the
+    // shared prefix once, take a snapshot, then fork it once per
+    // configuration so each only pays for its own suffix. A snapshot is
+    // immutable and shared by all its forks; a fork copies just the board
+    // state (the layout is shared), a few microseconds on a 9x9 board.
+    using Snapshot = std::shared_ptr<const BasicSudokuSolver>;
+    Snapshot snapshot() const { return std::make_shared<const BasicSudokuSolver>(*this); }
+    BasicSudokuSolver fork() const { return *this; }
+    static BasicSudokuSolver fork(const Snapshot& snapshot) { return *snapshot; }
+
+    // Backdoor of a stalled solve: the fewest open cells whose values from
+    // `solution` let the techniques finish, searched up to maxSize cells
+    // (cells stays empty if none is that small). Cells are placed one at a
+    // time with a solve() after each, skipping cells those solves filled.
+    // First cells are tried concurrently on the setParallel pool.
+    struct Backdoor {
+        std::vector<int> cells;
+        long trials = 0;   // solve() calls made
+    };
+    Backdoor findBackdoor(const std::vector<std::vector<int>>& solution, int maxSize,
+                          const Schedule* schedule = nullptr) const;
+private:
+    // Group structure for unified iteration. The layout is the same for
+    // every solver of a size, so copies and forks share it.
     struct Group {
         std::vector<std::pair<int,int>> cells;
-        Group() { cells.reserve(9); }
+        Group() { cells.reserve(N); }
+    };
+    struct Layout {
+        std::vector<Group> rows, cols, boxes;
     };
-    std::vector<Group> rows, cols, boxes;
+    static const Layout& layout();
+    const Group* rows = layout().rows.data();
+    const Group* cols = layout().cols.data();
+    const Group* boxes = layout().boxes.data();
+
+    // Technique steps in the order solve() tries them; after any step makes
+    // progress the search restarts from the first
+    using Step = bool (*)(BasicSudokuSolver&);
+    static const Step steps[STEP_COUNT];
+    bool speculate(const int* ids, int count, SolveObserver* observer);
+
+    // f(i) for i in [0, count), split into a few chunks per pool thread
+    template<typename Func>
+    void forEachParallel(int count, Func f) {
+        if (!pool) {
+            for (int i = 0; i < count; i++) f(i);
+            return;
+        }
+        const int chunks = std::min(count, 4 * pool->size());
+        pool->run(chunks, [&](int k) {
+            for (int i = k * count / chunks; i < (k + 1) * count / chunks; i++) f(i);
+        });
+    }
 
     // Process all groups with a given function
     template<typename Func>
     bool processGroups(Func func) {
         bool changed = false;
-        for (auto& group : rows) changed |= func(group);
-        for (auto& group : cols) changed |= func(group);
-        for (auto& group : boxes) changed |= func(group);
+        for (int i = 0; i < N; i++) changed |= func(rows[i]);
+        for (int i = 0; i < N; i++) changed |= func(cols[i]);
+        for (int i = 0; i < N; i++) changed |= func(boxes[i]);
         return changed;
     }
-    
+
     // Solving techniques
     bool eliminateBasic();
     bool checkNakedSingles();
@@ -61,31 +198,39 @@ private:
     bool findHiddenTriples();
     bool findHiddenQuads();
     bool findIntersectionRemoval();
-    
+
     // Wing techniques
+    bool eliminateFromCells(const CellSet& cells, int n);
     bool findXWing();
     bool findYWing();
     bool findXYZWing();
+    bool findWWing();
+    bool findWXYZWing();
 
     // Fish techniques
     bool findFish(int size, Tech tech);
     bool findSwordfish();
     bool findJellyfish();
 
-    // Rectangle techniques  
+    // Rectangle techniques
     bool findRectangleElimination();
 
-    // Chute Remote Pairs techniques  
+    // Chute Remote Pairs techniques
     bool findChuteRemotePairs();
 
+    // Uniqueness techniques, for puzzles with one solution
+    bool findUniqueRectangles();
+    bool checkRectangle(int a, int b, int c, int d, int x, int y);
+    bool checkRectangleRoof(int p, int q, int x, int y);
+    bool findBivalueGrave();
+
+    // ALS-XZ and ALS-XY-Wing over an index of almost locked sets
+    bool findAlmostLockedSets();
+
     // Coloring techniques
     bool findSimpleColoring();
     bool findXCycles();
     bool findSingleColoring();
-    bool testColoringHypothesis(int hr, int hc, int digit);
-    bool hasContradiction(const std::vector<std::vector<int>>& gridCopy,
-                         const std::vector<std::vector<std::bitset<10>>>& candidatesCopy,
-                         int digit);
 
     // Chain techniques
     bool findXChain();
@@ -93,29 +238,72 @@ private:
 
     // Helper methods for chains
     std::vector<ChainLink> findStrongLinks(int candidate);
-    std::vector<ChainLink> findXYChainLinks();
-    bool buildXChain(int startCell, int currentCell, int candidate, 
+    bool buildXChain(int startCell, int currentCell, int candidate,
                     bool needStrong, std::vector<int>& chain,
-                    std::bitset<81>& visited, 
+                    CellSet& visited,
                     const std::vector<ChainLink>& links);
-    bool buildXYChain(int startCell, int startCandidate, 
-                     int currentCell, int currentCandidate,
-                     bool isWithinCell, int numLinks,
-                     std::vector<int>& chain,
-                     std::bitset<81>& visited,
-                     const std::vector<ChainLink>& links);
+
+    // Nice loops, AICs and forcing chains over the candidate implication graph
+    bool findNiceLoops();
 
     // Helper functions
     void setCell(int r, int c, int n);
+    std::array<Word, Geo::NN> cellMasks() const;
+    void saveCell(int r, int c) {
+        if (openMarks) trail.push_back({r * N + c, grid[r][c], candidates[r][c]});
+    }
+    // All candidate changes go through these so the trail stays complete
+    bool removeCandidate(int r, int c, int n) {
+        if (!candidates[r][c][n]) return false;
+        saveCell(r, c);
+        candidates[r][c][n] = 0;
+        index.remove(r * N + c, n);
+        progress.eliminated++;
+        return true;
+    }
+    bool keepCandidates(int r, int c, const Mask& keep) {
+        if ((candidates[r][c] & ~keep).none()) return false;
+        saveCell(r, c);
+        progress.eliminated += (candidates[r][c] & ~keep).count();
+        candidates[r][c] &= keep;
+        index.update(r * N + c, candidates[r][c].to_ulong());
+        return true;
+    }
     bool canSee(int r1, int c1, int r2, int c2) const;
-    
+
 public:
     // Getters for grid and candidates
     const std::vector<std::vector<int>>& getGrid() const { return grid; }
-    const std::vector<std::vector<std::bitset<10>>>& getCandidates() const { return candidates; }
+    const std::vector<std::vector<Mask>>& getCandidates() const { return candidates; }
     const std::map<int, int>& getTechCount() const { return tech_count; }
+    const SolveProgress& getProgress() const { return progress; }
 };
 
-// Independent validation function
+extern template class BasicSudokuSolver<Geometry<2, 2>>;
+extern template class BasicSudokuSolver<Geometry<3, 3>>;
+extern template class BasicSudokuSolver<Geometry<4, 4>>;
+extern template class BasicSudokuSolver<Geometry<5, 5>>;
+
+using SudokuSolver = BasicSudokuSolver<Geometry<3, 3>>;      // 9x9
+using SudokuSolver4 = BasicSudokuSolver<Geometry<2, 2>>;     // 4x4
+using SudokuSolver16 = BasicSudokuSolver<Geometry<4, 4>>;    // 16x16
+using SudokuSolver25 = BasicSudokuSolver<Geometry<5, 5>>;    // 25x25
+
+// Independent validation function (any square-box size, taken from the grid)
 bool isValid(const std::vector<std::vector<int>>& grid);
-bool isFilled(const std::vector<std::vector<int>>& grid);
\ No newline at end of file
+bool isFilled(const std::vector<std::vector<int>>& grid);
+
+// Uniqueness and clue minimality of a puzzle string (16, 81, 256 or 625
+// characters). A clue is redundant when the puzzle without it still has
+// only one solution; a unique puzzle without redundant clues is minimal.
+struct ClueAnalysis {
+    int solutions = 0;            // 0, 1, or 2 for two or more
+    std::vector<int> clues;       // cell indexes of the clues
+    std::vector<int> redundant;   // clues that can be removed one at a time
+    bool minimal() const { return solutions == 1 && redundant.empty(); }
+};
+ClueAnalysis analyzeClues(const std::string& puzzle);
+
+// Solutions of a puzzle string, counted up to 2; the first one found is
+// stored in `solution` when given
+int countSolutions(const std::string& puzzle, std::vector<std::vector<int>>* solution = nullptr);
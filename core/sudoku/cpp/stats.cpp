@@ -0,0 +1,146 @@
+#include "stats.h"
+#include <algorithm>
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace {
+constexpr const char* MAGIC = "bsolver-stats";
+constexpr int VERSION = 1;
+}
+
+void BatchStats::merge(const BatchStats& other) {
+    puzzles += other.puzzles;
+    filled += other.filled;
+    solved += other.solved;
+    errorEmptyCandidates += other.errorEmptyCandidates;
+    errorWrongSolution += other.errorWrongSolution;
+    for (int t = 0; t < 2; t++) {
+        tierPuzzles[t] += other.tierPuzzles[t];
+        tierNanos[t] += other.tierNanos[t];
+    }
+    for (int id = 0; id < SolverBase::TECH_COUNT; id++) techCount[id] += other.techCount[id];
+    cluesAnalyzed += other.cluesAnalyzed;
+    noSolution += other.noSolution;
+    multipleSolutions += other.multipleSolutions;
+    minimal += other.minimal;
+    redundantClues += other.redundantClues;
+    for (int k = 0; k <= MAX_BACKDOOR; k++) backdoors[k] += other.backdoors[k];
+    backdoorCap = std::max(backdoorCap, other.backdoorCap);
+}
+
+bool BatchStats::save(const std::string& path) const {
+    const std::string tmp = path + ".tmp";
+    {
+        std::ofstream out(tmp);
+        out << MAGIC << ' ' << VERSION << '\n'
+            << "shard " << shard << ' ' << shards << '\n'
+            << "line " << line << '\n'
+            << "offset " << offset << '\n'
+            << "results_size " << resultsSize << '\n'
+            << "done " << int(done) << '\n'
+            << "puzzles " << puzzles << '\n'
+            << "filled " << filled << '\n'
+            << "solved " << solved << '\n'
+            << "empty_candidates " << errorEmptyCandidates << '\n'
+            << "wrong_solution " << errorWrongSolution << '\n'
+            << "minimality " << cluesAnalyzed << ' ' << noSolution << ' ' << multipleSolutions << ' '
+            << minimal << ' ' << redundantClues << '\n'
+            << "backdoors " << backdoorCap;
+        for (long n : backdoors) out << ' ' << n;
+        out << '\n';
+        for (int t = 0; t < 2; t++)
+            out << "tier " << t << ' ' << tierPuzzles[t] << ' ' << tierNanos[t] << '\n';
+        for (int id = 0; id < SolverBase::TECH_COUNT; id++)
+            if (techCount[id]) out << "tech " << id << ' ' << techCount[id] << '\n';
+        out.flush();
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmp, path, ec);
+    return !ec;
+}
+
+bool BatchStats::load(const std::string& path) {
+    std::ifstream in(path);
+    std::string magic;
+    int version = 0;
+    if (!(in >> magic >> version) || magic != MAGIC || version != VERSION) return false;
+
+    *this = BatchStats();
+    std::string row, key;
+    std::getline(in, row);
+    while (std::getline(in, row)) {
+        std::istringstream fields(row);
+        if (!(fields >> key)) continue;
+        if (key == "shard") {
+            fields >> shard >> shards;
+            if (shards < 1 || shard < 0 || shard >= shards) return false;
+        }
+        else if (key == "line") fields >> line;
+        else if (key == "offset") fields >> offset;
+        else if (key == "results_size") fields >> resultsSize;
+        else if (key == "done") { int d = 0; fields >> d; done = d; }
+        else if (key == "puzzles") fields >> puzzles;
+        else if (key == "filled") fields >> filled;
+        else if (key == "solved") fields >> solved;
+        else if (key == "empty_candidates") fields >> errorEmptyCandidates;
+        else if (key == "wrong_solution") fields >> errorWrongSolution;
+        else if (key == "minimality") fields >> cluesAnalyzed >> noSolution >> multipleSolutions >> minimal >> redundantClues;
+        else if (key == "backdoors") {
+            fields >> backdoorCap;
+            for (long& n : backdoors) fields >> n;
+        }
+        else if (key == "tier") {
+            int t = -1;
+            fields >> t;
+            if (t < 0 || t > 1) return false;
+            fields >> tierPuzzles[t] >> tierNanos[t];
+        } else if (key == "tech") {
+            int id = -1;
+            fields >> id;
+            if (id < 0 || id >= SolverBase::TECH_COUNT) return false;
+            fields >> techCount[id];
+        }
+        if (fields.fail()) return false;
+    }
+    return true;
+}
+
+void BatchStats::print(std::ostream& out) const {
+    std::vector<std::pair<int, long>> ordered;
+    for (int id = 0; id < SolverBase::TECH_COUNT; ++id)
+        ordered.emplace_back(id, techCount[id]);
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](auto& a, auto& b) { return a.second > b.second; });
+
+    out << "\nErrors: " << std::endl
+        << "    Empty Candidates        " << errorEmptyCandidates << std::endl
+        << "    Wrong Solution          " << errorWrongSolution
+        << std::endl;
+    out << "\nSolved:" << std::endl
+        << "                            " << solved << "/" << puzzles << std::endl;
+    out << "\nTiers:" << std::endl
+        << std::format("    {:<23} {:>6} {:>8.2f}s\n", "Singles kernel", tierPuzzles[TIER_SINGLES], tierNanos[TIER_SINGLES] * 1e-9)
+        << std::format("    {:<23} {:>6} {:>8.2f}s\n", "Full engine", tierPuzzles[TIER_FULL], tierNanos[TIER_FULL] * 1e-9);
+    if (cluesAnalyzed) {
+        out << "\nMinimality:" << std::endl
+            << std::format("    {:<23} {}\n", "Minimal", minimal)
+            << std::format("    {:<23} {}\n", "With redundant clues", cluesAnalyzed - noSolution - multipleSolutions - minimal)
+            << std::format("    {:<23} {}\n", "Redundant clues", redundantClues)
+            << std::format("    {:<23} {}\n", "Multiple solutions", multipleSolutions)
+            << std::format("    {:<23} {}\n", "No solution", noSolution);
+    }
+    if (backdoorCap) {
+        out << "\nBackdoors:" << std::endl;
+        for (int k = 1; k <= backdoorCap; k++)
+            out << std::format("    {:<23} {}\n", std::format("{} cell{}", k, k > 1 ? "s" : ""), backdoors[k]);
+        out << std::format("    {:<23} {}\n", std::format("More than {}", backdoorCap), backdoors[0]);
+    }
+    out << "\nUsed:"  << std::endl;
+    for (auto [id, cnt] : ordered) {
+        out << std::format("    {0:<{1}} {2}\n", SolverBase::tech_names[id], 23, cnt);
+    }
+}
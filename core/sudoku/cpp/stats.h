@@ -0,0 +1,53 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include "solver.h"
+
+// Aggregates of a bsolver run, plus where it stopped. Saved as a small
+// text file that doubles as the checkpoint of a run and as the shard
+// result that `bsolver merge` adds up.
+struct BatchStats {
+    enum { TIER_SINGLES, TIER_FULL };
+
+    // Position: next input line and its byte offset, bytes of --out written
+    int shard = 0, shards = 1;
+    uint64_t line = 0;
+    int64_t offset = 0;
+    int64_t resultsSize = 0;
+    bool done = false;
+
+    long puzzles = 0;
+    long filled = 0;
+    long solved = 0;
+    long errorEmptyCandidates = 0;
+    long errorWrongSolution = 0;
+    std::array<long, 2> tierPuzzles{};
+    std::array<int64_t, 2> tierNanos{};
+    std::array<long, SolverBase::TECH_COUNT> techCount{};
+
+    // --minimality
+    long cluesAnalyzed = 0;
+    long noSolution = 0;
+    long multipleSolutions = 0;
+    long minimal = 0;
+    long redundantClues = 0;
+
+    // --backdoor: stalled puzzles by backdoor size, [0] for none within the cap
+    static constexpr int MAX_BACKDOOR = 7;
+    std::array<long, MAX_BACKDOOR + 1> backdoors{};
+    int backdoorCap = 0;
+
+    // Add another shard's aggregates (position fields are left alone)
+    void merge(const BatchStats& other);
+
+    // Write to path through a temporary file and rename, so a run killed
+    // mid-save leaves the previous checkpoint intact
+    bool save(const std::string& path) const;
+    bool load(const std::string& path);
+
+    // The Errors / Solved / Tiers / Used report, plus Minimality and
+    // Backdoors if analyzed
+    void print(std::ostream& out) const;
+};
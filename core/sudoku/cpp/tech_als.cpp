@@ -0,0 +1,195 @@
+#include "solver.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+#include <vector>
+
+// Almost locked sets: k open cells of one house holding k + 1 digits,
+// enumerated from the per-house cell masks of the candidate index. For
+// each digit of a set the index keeps the cells that see all of the set's
+// cells with that digit; they lose the digit once the set must take it.
+// Sets are also listed by digit and first cell holding it, so the sets
+// whose cells with a digit all lie in some area are found from the cells
+// of the area. A set found in a box whose cells all lie on one line is
+// also found in that line and is skipped.
+template<typename Geo>
+struct AlsIndex {
+    static constexpr int N = Geo::N;
+    static constexpr int MAX_CELLS = std::min(N - 1, 5);
+    using Word = typename Geo::Word;
+    using CellSet = typename Geo::CellSet;
+
+    struct Als {
+        CellSet cells;
+        Word digits;
+        int seen;   // first of its digits in `seen`
+    };
+    std::vector<Als> sets;
+    std::vector<CellSet> seen;   // per set and digit, in digit order
+    std::vector<int> first;      // same, first cell with the digit
+    std::vector<int> byPlace;    // sets by digit and first cell with it
+    std::vector<int> placeStart; // start in byPlace of each digit * NN + cell
+
+    int slot(int i, int n) const { return sets[i].seen + std::popcount(Word(sets[i].digits & ((Word(1) << n) - 1))); }
+    const CellSet& seenBy(int i, int n) const { return seen[slot(i, n)]; }
+    int firstWith(int i, int n) const { return first[slot(i, n)]; }
+    // Sets whose first cell with digit n is `cell`
+    std::pair<const int*, const int*> at(int n, int cell) const {
+        const int place = n * Geo::NN + cell;
+        return {byPlace.data() + placeStart[place], byPlace.data() + placeStart[place + 1]};
+    }
+
+    explicit AlsIndex(const CandidateIndex<Geo>& index) {
+        const auto& geo = Geo::get();
+        std::vector<std::pair<int, int>> places;   // (digit * NN + first cell, set)
+        for (int h = 0; h < Geo::HOUSES; h++) {
+            int cells[N], count = 0;
+            for (int cell : geo.houseCells[h])
+                if (index.mask[cell]) cells[count++] = cell;
+            int chosen[MAX_CELLS];
+            auto extend = [&](auto& self, int from, int size, Word digits) -> void {
+                if (size && std::popcount(digits) == size + 1) add(index, chosen, size, digits, h >= 2 * N, places);
+                if (size == MAX_CELLS) return;
+                for (int i = from; i < count; i++) {
+                    const Word next = Word(digits | index.mask[cells[i]]);
+                    if (std::popcount(next) > MAX_CELLS + 1) continue;
+                    chosen[size] = cells[i];
+                    self(self, i + 1, size + 1, next);
+                }
+            };
+            extend(extend, 0, 0, 0);
+        }
+
+        // Counting sort of (place, set) pairs
+        placeStart.assign((N + 1) * Geo::NN + 1, 0);
+        for (const auto& [place, set] : places) placeStart[place + 1]++;
+        for (size_t i = 1; i < placeStart.size(); i++) placeStart[i] += placeStart[i - 1];
+        byPlace.resize(places.size());
+        std::vector<int> fill(placeStart.begin(), placeStart.end() - 1);
+        for (const auto& [place, set] : places) byPlace[fill[place]++] = set;
+    }
+
+private:
+    void add(const CandidateIndex<Geo>& index, const int* cells, int size, Word digits, bool box,
+             std::vector<std::pair<int, int>>& places) {
+        const auto& geo = Geo::get();
+        if (box) {
+            bool row = true, col = true;
+            for (int i = 1; i < size; i++) {
+                row &= cells[i] / N == cells[0] / N;
+                col &= cells[i] % N == cells[0] % N;
+            }
+            if (row || col) return;
+        }
+        Als als{{}, digits, int(seen.size())};
+        for (int i = 0; i < size; i++) als.cells[cells[i]] = 1;
+        for (Word w = digits; w; w &= w - 1) {
+            const int n = std::countr_zero(w);
+            CellSet all;
+            all.set();
+            int cell = Geo::NN;
+            for (int i = 0; i < size; i++) {
+                if (!(index.mask[cells[i]] >> n & 1)) continue;
+                all &= geo.peerMask[cells[i]];
+                cell = std::min(cell, cells[i]);
+            }
+            seen.push_back(all & ~als.cells);
+            first.push_back(cell);
+            places.push_back({n * Geo::NN + cell, int(sets.size())});
+        }
+        sets.push_back(als);
+    }
+};
+
+// ALS-XZ and ALS-XY-Wing. Two disjoint sets are linked by a restricted
+// common digit x when every cell of one with x sees every cell of the
+// other with x: x goes in at most one of them, so the other is locked.
+//   ALS-XZ: sets A and B linked by x; another digit z of both is in A or
+//   B, so cells seeing all z of both lose z. With two links, both sets
+//   are locked: each digit but the links leaves the cells that see all of
+//   it in its set, and each link the cells that see all of it in both.
+//   ALS-XY-Wing: A linked to a pivot C by x, B to C by y; one of A and B
+//   is locked, so a digit z of both (not x or y) goes as in ALS-XZ.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findAlmostLockedSets() {
+    const auto& geo = Geo::get();
+    const AlsIndex<Geo> als(index);
+    const int count = int(als.sets.size());
+    bool changed = false;
+
+    // z leaves the cells that see all its places in the given sets
+    auto eliminate = [&](int a, int b, int z, Tech tech) {
+        CellSet targets = als.seenBy(a, z) & index.positions[z];
+        if (b >= 0) targets &= als.seenBy(b, z);
+        if (!eliminateFromCells(targets, z)) return;
+        tech_count[tech]++;
+        changed = true;
+    };
+
+    // Links between sets: for a digit x of A, the sets B whose cells with x
+    // all see A's, listed under the cells that see all of A's
+    struct Link { int a, b; Word common; };
+    std::vector<Link> links;
+    std::vector<Word> common(count);
+    std::vector<int> touched;
+    for (int a = 0; a < count; a++) {
+        const auto& A = als.sets[a];
+        for (Word w = A.digits; w; w &= w - 1) {
+            const int x = std::countr_zero(w);
+            const CellSet area = als.seenBy(a, x) & index.positions[x];
+            for (int cell : geo.peers[als.firstWith(a, x)]) {
+                if (!area[cell]) continue;
+                for (auto [it, end] = als.at(x, cell); it != end; ++it) {
+                    const int b = *it;
+                    const auto& B = als.sets[b];
+                    if (b <= a || (A.cells & B.cells).any() || (index.positions[x] & B.cells & ~area).any()) continue;
+                    if (!common[b]) touched.push_back(b);
+                    common[b] |= Word(1) << x;
+                }
+            }
+        }
+        for (int b : touched) {
+            links.push_back({a, b, common[b]});
+            common[b] = 0;
+        }
+        touched.clear();
+    }
+
+    // ALS-XZ
+    for (const auto& [a, b, rcc] : links) {
+        const Word shared = Word(als.sets[a].digits & als.sets[b].digits);
+        if (std::popcount(rcc) == 1) {
+            for (Word w = shared & ~rcc; w; w &= w - 1) eliminate(a, b, std::countr_zero(w), ALS_XZ);
+        } else if (std::popcount(rcc) == 2) {
+            for (Word w = rcc; w; w &= w - 1) eliminate(a, b, std::countr_zero(w), ALS_XZ);
+            for (int s : {a, b})
+                for (Word w = als.sets[s].digits & ~rcc; w; w &= w - 1) eliminate(s, -1, std::countr_zero(w), ALS_XZ);
+        }
+    }
+
+    if (changed) return true;
+
+    // ALS-XY-Wing: the links of each pivot, by link digit
+    std::vector<std::vector<std::pair<int, int>>> around(count);
+    for (const auto& [a, b, rcc] : links) {
+        for (Word w = rcc; w; w &= w - 1) {
+            around[a].push_back({b, std::countr_zero(w)});
+            around[b].push_back({a, std::countr_zero(w)});
+        }
+    }
+    for (int c = 0; c < count; c++) {
+        const auto& wings = around[c];
+        for (size_t i = 0; i < wings.size(); i++) {
+            for (size_t j = i + 1; j < wings.size(); j++) {
+                const auto [a, x] = wings[i];
+                const auto [b, y] = wings[j];
+                const Word z = Word(als.sets[a].digits & als.sets[b].digits & ~(Word(1) << x | Word(1) << y));
+                if (!z || x == y || a == b || (als.sets[a].cells & als.sets[b].cells).any()) continue;
+                for (Word w = z; w; w &= w - 1) eliminate(a, b, std::countr_zero(w), ALS_XY_WING);
+            }
+        }
+    }
+    return changed;
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
@@ -2,31 +2,23 @@
 #include <algorithm>
 #include <bit>
 
-bool SudokuSolver::eliminateBasic() {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::eliminateBasic() {
     bool changed = false;
-    for (int r = 0; r < 9; r++) {
-        for (int c = 0; c < 9; c++) {
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
             if (grid[r][c] != 0) continue;
             
             // Eliminate from row, column, box
-            for (int i = 0; i < 9; i++) {
-                if (grid[r][i] && candidates[r][c][grid[r][i]]) {
-                    candidates[r][c][grid[r][i]] = 0;
-                    changed = true;
-                }
-                if (grid[i][c] && candidates[r][c][grid[i][c]]) {
-                    candidates[r][c][grid[i][c]] = 0;
-                    changed = true;
-                }
+            for (int i = 0; i < N; i++) {
+                if (grid[r][i] && removeCandidate(r, c, grid[r][i])) changed = true;
+                if (grid[i][c] && removeCandidate(r, c, grid[i][c])) changed = true;
             }
             
-            int br = (r/3)*3, bc = (c/3)*3;
-            for (int i = 0; i < 3; i++) {
-                for (int j = 0; j < 3; j++) {
-                    if (grid[br+i][bc+j] && candidates[r][c][grid[br+i][bc+j]]) {
-                        candidates[r][c][grid[br+i][bc+j]] = 0;
-                        changed = true;
-                    }
+            int br = (r/BR)*BR, bc = (c/BC)*BC;
+            for (int i = 0; i < BR; i++) {
+                for (int j = 0; j < BC; j++) {
+                    if (grid[br+i][bc+j] && removeCandidate(r, c, grid[br+i][bc+j])) changed = true;
                 }
             }
         }
@@ -35,12 +27,13 @@ bool SudokuSolver::eliminateBasic() {
     return changed;
 }
 
-bool SudokuSolver::checkNakedSingles() {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::checkNakedSingles() {
     bool changed = false;
-    for (int r = 0; r < 9; r++) {
-        for (int c = 0; c < 9; c++) {
+    for (int r = 0; r < N; r++) {
+        for (int c = 0; c < N; c++) {
             if (grid[r][c] == 0 && candidates[r][c].count() == 1) {
-                for (int n = 1; n <= 9; n++) {
+                for (int n = 1; n <= N; n++) {
                     if (candidates[r][c][n]) {
                         setCell(r, c, n);
                         changed = true;
@@ -54,10 +47,11 @@ bool SudokuSolver::checkNakedSingles() {
     return changed;
 }
 
-bool SudokuSolver::findHiddenSingles() {
-    return processGroups([&](Group& g) {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findHiddenSingles() {
+    return processGroups([&](const Group& g) {
         bool changed = false;
-        for (int n = 1; n <= 9; n++) {
+        for (int n = 1; n <= N; n++) {
             int pos = -1, cnt = 0;
             for (size_t i = 0; i < g.cells.size(); i++) {
                 auto [r, c] = g.cells[i];
@@ -78,8 +72,9 @@ bool SudokuSolver::findHiddenSingles() {
 }
 
 // Generic naked sets finder (pairs, triples, quads)
-bool SudokuSolver::findNakedSets(int size, Tech tech) {
-    return processGroups([&](Group& g) {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findNakedSets(int size, Tech tech) {
+    return processGroups([&](const Group& g) {
         bool changed = false;
         std::vector<int> empty_cells;
         
@@ -97,7 +92,7 @@ bool SudokuSolver::findNakedSets(int size, Tech tech) {
         std::function<bool(int, int)> tryCombo = [&](int start, int depth) {
             if (depth == size) {
                 // Check if union has exactly 'size' candidates
-                std::bitset<10> combined;
+                Mask combined;
                 for (int idx : combo) {
                     auto [r, c] = g.cells[empty_cells[idx]];
                     combined |= candidates[r][c];
@@ -116,9 +111,7 @@ bool SudokuSolver::findNakedSets(int size, Tech tech) {
                             }
                         }
                         if (!is_in_set) {
-                            auto old = candidates[r][c];
-                            candidates[r][c] &= ~combined;
-                            if (old != candidates[r][c]) found_elim = true;
+                            if (keepCandidates(r, c, ~combined)) found_elim = true;
                         }
                     }
                     if (found_elim) {
@@ -141,12 +134,13 @@ bool SudokuSolver::findNakedSets(int size, Tech tech) {
     });
 }
 
-bool SudokuSolver::findHiddenPairs() {
-    return processGroups([&](Group& g) {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findHiddenPairs() {
+    return processGroups([&](const Group& g) {
         bool changed = false;
         
-        for (int n1 = 1; n1 < 9; n1++) {
-            for (int n2 = n1+1; n2 <= 9; n2++) {
+        for (int n1 = 1; n1 < N; n1++) {
+            for (int n2 = n1+1; n2 <= N; n2++) {
                 std::vector<int> positions;
                 
                 // Find cells containing n1 or n2
@@ -182,10 +176,9 @@ bool SudokuSolver::findHiddenPairs() {
                             // Keep only n1 and n2 in these cells
                             for (int pos : positions) {
                                 auto [r, c] = g.cells[pos];
-                                auto old = candidates[r][c];
-                                candidates[r][c].reset();
-                                candidates[r][c][n1] = candidates[r][c][n2] = 1;
-                                if (old != candidates[r][c]) changed = true;
+                                Mask keep;
+                                keep[n1] = keep[n2] = 1;
+                                if (keepCandidates(r, c, keep)) changed = true;
                             }
                             if (changed) tech_count[HIDDEN_PAIR]++;
                         }
@@ -197,14 +190,15 @@ bool SudokuSolver::findHiddenPairs() {
     });
 }
 
-bool SudokuSolver::findHiddenTriples() {
-    return processGroups([&](Group& g) {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findHiddenTriples() {
+    return processGroups([&](const Group& g) {
         bool changed = false;
         
         // Try all combinations of 3 numbers
-        for (int n1 = 1; n1 <= 7; n1++) {
-            for (int n2 = n1+1; n2 <= 8; n2++) {
-                for (int n3 = n2+1; n3 <= 9; n3++) {
+        for (int n1 = 1; n1 <= N-2; n1++) {
+            for (int n2 = n1+1; n2 <= N-1; n2++) {
+                for (int n3 = n2+1; n3 <= N; n3++) {
                     std::vector<int> positions;
                     
                     // Find cells containing any of n1, n2, n3
@@ -245,12 +239,9 @@ bool SudokuSolver::findHiddenTriples() {
                                 bool found_elim = false;
                                 for (int pos : positions) {
                                     auto [r, c] = g.cells[pos];
-                                    auto old = candidates[r][c];
-                                    candidates[r][c].reset();
-                                    candidates[r][c][n1] = old[n1];
-                                    candidates[r][c][n2] = old[n2];
-                                    candidates[r][c][n3] = old[n3];
-                                    if (old != candidates[r][c]) found_elim = true;
+                                    Mask keep;
+                                    keep[n1] = keep[n2] = keep[n3] = 1;
+                                    if (keepCandidates(r, c, keep)) found_elim = true;
                                 }
                                 if (found_elim) {
                                     changed = true;
@@ -266,15 +257,16 @@ bool SudokuSolver::findHiddenTriples() {
     });
 }
 
-bool SudokuSolver::findHiddenQuads() {
-    return processGroups([&](Group& g) {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findHiddenQuads() {
+    return processGroups([&](const Group& g) {
         bool changed = false;
         
         // Try all combinations of 4 numbers
-        for (int n1 = 1; n1 <= 6; n1++) {
-            for (int n2 = n1+1; n2 <= 7; n2++) {
-                for (int n3 = n2+1; n3 <= 8; n3++) {
-                    for (int n4 = n3+1; n4 <= 9; n4++) {
+        for (int n1 = 1; n1 <= N-3; n1++) {
+            for (int n2 = n1+1; n2 <= N-2; n2++) {
+                for (int n3 = n2+1; n3 <= N-1; n3++) {
+                    for (int n4 = n3+1; n4 <= N; n4++) {
                         std::vector<int> positions;
                         
                         // Find cells containing any of n1, n2, n3, n4
@@ -317,13 +309,9 @@ bool SudokuSolver::findHiddenQuads() {
                                     bool found_elim = false;
                                     for (int pos : positions) {
                                         auto [r, c] = g.cells[pos];
-                                        auto old = candidates[r][c];
-                                        candidates[r][c].reset();
-                                        candidates[r][c][n1] = old[n1];
-                                        candidates[r][c][n2] = old[n2];
-                                        candidates[r][c][n3] = old[n3];
-                                        candidates[r][c][n4] = old[n4];
-                                        if (old != candidates[r][c]) found_elim = true;
+                                        Mask keep;
+                                        keep[n1] = keep[n2] = keep[n3] = keep[n4] = 1;
+                                        if (keepCandidates(r, c, keep)) found_elim = true;
                                     }
                                     if (found_elim) {
                                         changed = true;
@@ -340,14 +328,15 @@ bool SudokuSolver::findHiddenQuads() {
     });
 }
 
-bool SudokuSolver::findIntersectionRemoval() {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findIntersectionRemoval() {
     bool changed = false;
     
     // Pointing pairs/triples
-    for (int b = 0; b < 9; b++) {
-        int br = (b/3)*3, bc = (b%3)*3;
+    for (int b = 0; b < N; b++) {
+        int br = Geo::boxRow(b), bc = Geo::boxCol(b);
         
-        for (int n = 1; n <= 9; n++) {
+        for (int n = 1; n <= N; n++) {
             // Check if candidates align in row/col
             unsigned int row_mask = 0, col_mask = 0;
             for (auto [r, c] : boxes[b].cells) {
@@ -360,12 +349,9 @@ bool SudokuSolver::findIntersectionRemoval() {
             // Single row in box
             if (std::popcount(row_mask) == 1) {
                 int r = br + std::countr_zero(row_mask);
-                for (int c = 0; c < 9; c++) {
-                    if (c >= bc && c < bc+3) continue;
-                    if (grid[r][c] == 0 && candidates[r][c][n]) {
-                        candidates[r][c][n] = 0;
-                        changed = true;
-                    }
+                for (int c = 0; c < N; c++) {
+                    if (c >= bc && c < bc+BC) continue;
+                    if (grid[r][c] == 0 && removeCandidate(r, c, n)) changed = true;
                 }
                 if (changed) tech_count[POINTING_PAIRS]++;
             }
@@ -373,12 +359,9 @@ bool SudokuSolver::findIntersectionRemoval() {
             // Single column in box
             if (std::popcount(col_mask) == 1) {
                 int c = bc + std::countr_zero(col_mask);
-                for (int r = 0; r < 9; r++) {
-                    if (r >= br && r < br+3) continue;
-                    if (grid[r][c] == 0 && candidates[r][c][n]) {
-                        candidates[r][c][n] = 0;
-                        changed = true;
-                    }
+                for (int r = 0; r < N; r++) {
+                    if (r >= br && r < br+BR) continue;
+                    if (grid[r][c] == 0 && removeCandidate(r, c, n)) changed = true;
                 }
                 if (changed) tech_count[POINTING_PAIRS]++;
             }
@@ -386,22 +369,19 @@ bool SudokuSolver::findIntersectionRemoval() {
     }
     
     // Box-line reduction
-    for (int i = 0; i < 9; i++) {
-        for (int n = 1; n <= 9; n++) {
+    for (int i = 0; i < N; i++) {
+        for (int n = 1; n <= N; n++) {
             // Check rows
             unsigned int box_mask = 0;
             for (auto [r, c] : rows[i].cells) {
                 if (grid[r][c] == 0 && candidates[r][c][n])
-                    box_mask |= (1 << (c/3));
+                    box_mask |= (1 << (c/BC));
             }
             
             if (std::popcount(box_mask) == 1) {
-                int box = (i/3)*3 + std::countr_zero(box_mask);
+                int box = (i/BR)*BR + std::countr_zero(box_mask);
                 for (auto [r, c] : boxes[box].cells) {
-                    if (r != i && grid[r][c] == 0 && candidates[r][c][n]) {
-                        candidates[r][c][n] = 0;
-                        changed = true;
-                    }
+                    if (r != i && grid[r][c] == 0 && removeCandidate(r, c, n)) changed = true;
                 }
                 if (changed) tech_count[BOX_LINE]++;
             }
@@ -410,16 +390,13 @@ bool SudokuSolver::findIntersectionRemoval() {
             box_mask = 0;
             for (auto [r, c] : cols[i].cells) {
                 if (grid[r][c] == 0 && candidates[r][c][n])
-                    box_mask |= (1 << (r/3));
+                    box_mask |= (1 << (r/BR));
             }
             
             if (std::popcount(box_mask) == 1) {
-                int box = std::countr_zero(box_mask) * 3 + i/3;
+                int box = std::countr_zero(box_mask) * BR + i/BC;
                 for (auto [r, c] : boxes[box].cells) {
-                    if (c != i && grid[r][c] == 0 && candidates[r][c][n]) {
-                        candidates[r][c][n] = 0;
-                        changed = true;
-                    }
+                    if (c != i && grid[r][c] == 0 && removeCandidate(r, c, n)) changed = true;
                 }
                 if (changed) tech_count[BOX_LINE]++;
             }
@@ -427,4 +404,6 @@ bool SudokuSolver::findIntersectionRemoval() {
     }
     
     return changed;
-}
\ No newline at end of file
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
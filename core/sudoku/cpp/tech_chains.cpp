@@ -1,82 +1,33 @@
 #include "solver.h"
 #include <algorithm>
+#include <bit>
 #include <vector>
 #include <bitset>
+#include <array>
 
-// Find strong links for a candidate within houses (row/col/box)
-std::vector<ChainLink> SudokuSolver::findStrongLinks(int candidate) {
+// Find strong links for a candidate within houses (row/col/box), from the
+// conjugate pairs of the candidate index
+template<typename Geo>
+std::vector<ChainLink> BasicSudokuSolver<Geo>::findStrongLinks(int candidate) {
     std::vector<ChainLink> links;
     
-    // Check rows
-    for (int r = 0; r < 9; r++) {
-        std::vector<int> positions;
-        for (int c = 0; c < 9; c++) {
-            if (grid[r][c] == 0 && candidates[r][c][candidate]) {
-                positions.push_back(r * 9 + c);
-            }
-        }
-        if (positions.size() == 2) {
-            // Strong link found - toCand same as candidate for X-Chain
-            links.push_back({positions[0], positions[1], candidate, candidate, true});
-            links.push_back({positions[1], positions[0], candidate, candidate, true});
-        }
-    }
-    
-    // Check columns
-    for (int c = 0; c < 9; c++) {
-        std::vector<int> positions;
-        for (int r = 0; r < 9; r++) {
-            if (grid[r][c] == 0 && candidates[r][c][candidate]) {
-                positions.push_back(r * 9 + c);
-            }
-        }
-        if (positions.size() == 2) {
-            // Strong link found
-            links.push_back({positions[0], positions[1], candidate, candidate, true});
-            links.push_back({positions[1], positions[0], candidate, candidate, true});
-        }
-    }
-    
-    // Check boxes
-    for (int box = 0; box < 9; box++) {
-        int br = (box / 3) * 3;
-        int bc = (box % 3) * 3;
-        std::vector<int> positions;
-        
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                int r = br + i, c = bc + j;
-                if (grid[r][c] == 0 && candidates[r][c][candidate]) {
-                    positions.push_back(r * 9 + c);
-                }
-            }
-        }
-        
-        if (positions.size() == 2) {
-            // Strong link found - check if not already added from row/col
-            bool alreadyAdded = false;
-            int r0 = positions[0] / 9, c0 = positions[0] % 9;
-            int r1 = positions[1] / 9, c1 = positions[1] % 9;
-            
-            if (r0 == r1 || c0 == c1) {
-                alreadyAdded = true;  // Already added in row/col check
-            }
-            
-            if (!alreadyAdded) {
-                links.push_back({positions[0], positions[1], candidate, candidate, true});
-                links.push_back({positions[1], positions[0], candidate, candidate, true});
-            }
-        }
+    for (int h = 0, a, b; h < Geo::HOUSES; h++) {
+        if (!index.conjugate(h, candidate, a, b)) continue;
+        // A box pair in one row or column was already added from that house
+        if (h >= 2 * N && (a / N == b / N || a % N == b % N)) continue;
+        // Strong link found - toCand same as candidate for X-Chain
+        links.push_back({a, b, candidate, candidate, true});
+        links.push_back({b, a, candidate, candidate, true});
     }
     
     // Add weak links (any cell that can see another with same candidate)
-    for (int cell1 = 0; cell1 < 81; cell1++) {
-        int r1 = cell1 / 9, c1 = cell1 % 9;
-        if (grid[r1][c1] != 0 || !candidates[r1][c1][candidate]) continue;
+    for (int cell1 = 0; cell1 < Geo::NN; cell1++) {
+        int r1 = cell1 / N, c1 = cell1 % N;
+        if (!index.positions[candidate][cell1]) continue;
         
-        for (int cell2 = cell1 + 1; cell2 < 81; cell2++) {
-            int r2 = cell2 / 9, c2 = cell2 % 9;
-            if (grid[r2][c2] != 0 || !candidates[r2][c2][candidate]) continue;
+        for (int cell2 = cell1 + 1; cell2 < Geo::NN; cell2++) {
+            int r2 = cell2 / N, c2 = cell2 % N;
+            if (!index.positions[candidate][cell2]) continue;
             
             if (canSee(r1, c1, r2, c2)) {
                 // Check if already have strong link
@@ -101,9 +52,10 @@ std::vector<ChainLink> SudokuSolver::findStrongLinks(int candidate) {
 }
 
 // Build X-Chain recursively
-bool SudokuSolver::buildXChain(int startCell, int currentCell, int candidate, 
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::buildXChain(int startCell, int currentCell, int candidate, 
                               bool needStrong, std::vector<int>& chain,
-                              std::bitset<81>& visited, 
+                              CellSet& visited, 
                               const std::vector<ChainLink>& links) {
     
     // Max chain length check (in links, not cells)
@@ -113,13 +65,13 @@ bool SudokuSolver::buildXChain(int startCell, int currentCell, int candidate,
     // Need at least 3 links (4 cells) and last link must be strong
     if (chain.size() >= 3 && !needStrong) {
         // Last link was strong, check for eliminations
-        int r1 = startCell / 9, c1 = startCell % 9;
-        int r2 = currentCell / 9, c2 = currentCell % 9;
+        int r1 = startCell / N, c1 = startCell % N;
+        int r2 = currentCell / N, c2 = currentCell % N;
         
         // Find cells that can see both ends
         bool found = false;
-        for (int cell = 0; cell < 81; cell++) {
-            int r = cell / 9, c = cell % 9;
+        for (int cell = 0; cell < Geo::NN; cell++) {
+            int r = cell / N, c = cell % N;
             if (grid[r][c] == 0 && candidates[r][c][candidate] &&
                 canSee(r, c, r1, c1) && canSee(r, c, r2, c2) &&
                 cell != startCell && cell != currentCell) {
@@ -134,7 +86,7 @@ bool SudokuSolver::buildXChain(int startCell, int currentCell, int candidate,
                 }
                 
                 if (!inChain) {
-                    candidates[r][c][candidate] = 0;
+                    removeCandidate(r, c, candidate);
                     found = true;
                 }
             }
@@ -170,16 +122,17 @@ bool SudokuSolver::buildXChain(int startCell, int currentCell, int candidate,
     return false;
 }
 
-bool SudokuSolver::findXChain() {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findXChain() {
     bool changed = false;
     
     // Try each candidate
-    for (int candidate = 1; candidate <= 9; candidate++) {
+    for (int candidate = 1; candidate <= N; candidate++) {
         auto links = findStrongLinks(candidate);
         
         // Try starting from each cell with this candidate
-        for (int startCell = 0; startCell < 81; startCell++) {
-            int r = startCell / 9, c = startCell % 9;
+        for (int startCell = 0; startCell < Geo::NN; startCell++) {
+            int r = startCell / N, c = startCell % N;
             if (grid[r][c] != 0 || !candidates[r][c][candidate]) continue;
             
             // Start chain with strong link from this cell
@@ -187,7 +140,7 @@ bool SudokuSolver::findXChain() {
                 if (link.fromCell != startCell || !link.isStrong) continue;
                 
                 std::vector<int> chain = {startCell, link.toCell};
-                std::bitset<81> visited;
+                CellSet visited;
                 visited[startCell] = true;
                 visited[link.toCell] = true;
                 
@@ -202,171 +155,88 @@ bool SudokuSolver::findXChain() {
     return changed;
 }
 
-// Find links for XY-Chain (bivalue cells)
-std::vector<ChainLink> SudokuSolver::findXYChainLinks() {
-    std::vector<ChainLink> links;
-    
-    // For each bivalue cell, add internal strong links
-    for (int cell = 0; cell < 81; cell++) {
-        int r = cell / 9, c = cell % 9;
-        if (grid[r][c] != 0 || candidates[r][c].count() != 2) continue;
-        
-        std::vector<int> cellCands;
-        for (int n = 1; n <= 9; n++) {
-            if (candidates[r][c][n]) cellCands.push_back(n);
-        }
-        
-        // Strong links within the cell (from one candidate to another)
-        // From cand0 to cand1
-        links.push_back({cell, cell, cellCands[0], cellCands[1], true});
-        // From cand1 to cand0  
-        links.push_back({cell, cell, cellCands[1], cellCands[0], true});
-    }
-    
-    // Add weak links between bivalue cells that can see each other
-    for (int cell1 = 0; cell1 < 81; cell1++) {
-        int r1 = cell1 / 9, c1 = cell1 % 9;
-        if (grid[r1][c1] != 0 || candidates[r1][c1].count() != 2) continue;
-        
-        for (int cell2 = cell1 + 1; cell2 < 81; cell2++) {
-            int r2 = cell2 / 9, c2 = cell2 % 9;
-            if (grid[r2][c2] != 0 || candidates[r2][c2].count() != 2) continue;
-            
-            if (!canSee(r1, c1, r2, c2)) continue;
-            
-            // Check for common candidates
-            for (int n = 1; n <= 9; n++) {
-                if (candidates[r1][c1][n] && candidates[r2][c2][n]) {
-                    // Weak link on common candidate
-                    links.push_back({cell1, cell2, n, n, false});
-                    links.push_back({cell2, cell1, n, n, false});
-                }
-            }
-        }
+// XY-Chain by BFS over the bivalue implication graph. State 2*i+k means
+// "bivalue cell i takes its k-th candidate"; it forces every bivalue peer
+// sharing that digit onto its other candidate. Reaching "end is x" from
+// "start is not x" proves one of the two ends holds x, so x can be removed
+// from their common peers. Remote pairs are the case where all cells share
+// the same pair and need no separate search.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findXYChain() {
+    const auto& geo = Geo::get();
+    using States = std::bitset<2 * Geo::NN>;
+
+    // Bivalue cells and their digits, from the candidate index
+    std::vector<int> bivalue;
+    std::vector<std::array<int, 2>> values;
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        if (!index.bivalue[cell]) continue;
+        bivalue.push_back(cell);
+        values.push_back({std::countr_zero(index.mask[cell]), int(std::bit_width(index.mask[cell])) - 1});
     }
-    
-    return links;
-}
+    const auto& positions = index.positions;
+    const int B = bivalue.size();
+    if (B < 2) return false;
 
-// Build XY-Chain recursively
-bool SudokuSolver::buildXYChain(int startCell, int startCandidate, 
-                               int currentCell, int currentCandidate,
-                               bool isWithinCell, int numLinks,
-                               std::vector<int>& chain,
-                               std::bitset<81>& visited,
-                               const std::vector<ChainLink>& links) {
-    
-    // Max chain length check
-    if (numLinks > 20) return false;
-    
-    // Check if we can complete the chain
-    // Need at least 3 links and ending with startCandidate in different cell
-    if (numLinks >= 3 && currentCandidate == startCandidate && 
-        currentCell != startCell && !isWithinCell) {
-        
-        int r1 = startCell / 9, c1 = startCell % 9;
-        int r2 = currentCell / 9, c2 = currentCell % 9;
-        
-        // Find cells that can see both ends
-        bool found = false;
-        for (int cell = 0; cell < 81; cell++) {
-            int r = cell / 9, c = cell % 9;
-            if (grid[r][c] == 0 && candidates[r][c][startCandidate] &&
-                canSee(r, c, r1, c1) && canSee(r, c, r2, c2) &&
-                cell != startCell && cell != currentCell) {
-                
-                // Check that this cell is not part of the chain
-                bool inChain = false;
-                for (int chainCell : chain) {
-                    if (chainCell == cell) {
-                        inChain = true;
-                        break;
-                    }
-                }
-                
-                if (!inChain) {
-                    candidates[r][c][startCandidate] = 0;
-                    found = true;
+    // Implications between states, and the states in which a cell holds each digit
+    std::vector<States> next(2 * B);
+    std::array<States, N + 1> holds{};
+    for (int i = 0; i < B; i++) {
+        holds[values[i][0]][2*i] = 1;
+        holds[values[i][1]][2*i + 1] = 1;
+        for (int j = i + 1; j < B; j++) {
+            if (!geo.peerMask[bivalue[i]][bivalue[j]]) continue;
+            for (int a = 0; a < 2; a++) {
+                for (int b = 0; b < 2; b++) {
+                    if (values[i][a] != values[j][b]) continue;
+                    next[2*i + a][2*j + 1 - b] = 1;
+                    next[2*j + b][2*i + 1 - a] = 1;
                 }
             }
         }
-        
-        if (found) {
-            tech_count[XY_CHAIN]++;
-            return true;
-        }
     }
-    
-    // Continue building chain
-    for (const auto& link : links) {
-        if (link.fromCell != currentCell || link.candidate != currentCandidate) continue;
-        
-        if (isWithinCell) {
-            // Must be strong link within same cell
-            if (!link.isStrong || link.toCell != currentCell) continue;
-            
-            // The toCand is the next candidate we'll work with
-            if (buildXYChain(startCell, startCandidate, currentCell, link.toCand,
-                           false, numLinks + 1, chain, visited, links)) {
-                return true;
-            }
-        } else {
-            // Must be weak link to another cell
-            if (link.isStrong || link.toCell == currentCell) continue;
-            if (visited[link.toCell]) continue;
-            
-            // Check that target is bivalue cell
-            int tr = link.toCell / 9, tc = link.toCell % 9;
-            if (candidates[tr][tc].count() != 2) continue;
-            
-            chain.push_back(link.toCell);
-            visited[link.toCell] = true;
-            
-            // Next step will be within the new cell
-            // Current candidate stays the same (we just moved to new cell)
-            if (buildXYChain(startCell, startCandidate, link.toCell, currentCandidate,
-                           true, numLinks + 1, chain, visited, links)) {
-                return true;
+
+    // BFS from every "start is not x" state; the level at which an end is
+    // first reached is the length of the shortest chain between them
+    struct Chain { int length, start, end, digit; };
+    std::vector<Chain> chains;
+    for (int s = 0; s < 2 * B; s++) {
+        int start = s / 2, x = values[start][1 - s % 2];
+        States visited, frontier;
+        visited[s] = frontier[s] = 1;
+        for (int length = 1; frontier.any(); length++) {
+            States reached;
+            for (int t = 0; t < 2 * B; t++)
+                if (frontier[t]) reached |= next[t];
+            frontier = reached & ~visited;
+            visited |= frontier;
+
+            States ends = frontier & holds[x];
+            ends[2*start] = ends[2*start + 1] = 0;
+            for (int t = 0; t < 2 * B; t++) {
+                if (!ends[t]) continue;
+                int end = t / 2;
+                auto elim = geo.peerMask[bivalue[start]] & geo.peerMask[bivalue[end]] & positions[x];
+                if (elim.any()) chains.push_back({length, bivalue[start], bivalue[end], x});
             }
-            
-            chain.pop_back();
-            visited[link.toCell] = false;
         }
     }
-    
-    return false;
-}
 
-bool SudokuSolver::findXYChain() {
+    // Apply shortest chains first; longer ones only count if they still eliminate
+    std::stable_sort(chains.begin(), chains.end(),
+                     [](const Chain& a, const Chain& b) { return a.length < b.length; });
     bool changed = false;
-    auto links = findXYChainLinks();
-    
-    // Try starting from each bivalue cell
-    for (int startCell = 0; startCell < 81; startCell++) {
-        int r = startCell / 9, c = startCell % 9;
-        if (grid[r][c] != 0 || candidates[r][c].count() != 2) continue;
-        
-        // Get both candidates in start cell
-        std::vector<int> startCands;
-        for (int n = 1; n <= 9; n++) {
-            if (candidates[r][c][n]) startCands.push_back(n);
-        }
-        
-        // Try starting with each candidate
-        // First link is within the cell (from one candidate to another)
-        for (int i = 0; i < 2; i++) {
-            int startCand = startCands[i];
-            std::vector<int> chain = {startCell};
-            std::bitset<81> visited;
-            visited[startCell] = true;
-            
-            // Start with internal transition in first cell
-            if (buildXYChain(startCell, startCand, startCell, startCand,
-                           true, 0, chain, visited, links)) {
-                changed = true;
-            }
-        }
+    for (const auto& chain : chains) {
+        auto elim = geo.peerMask[chain.start] & geo.peerMask[chain.end] & positions[chain.digit];
+        if (elim.none()) continue;
+        for (int cell = 0; cell < Geo::NN; cell++) {
+            if (elim[cell]) removeCandidate(cell / N, cell % N, chain.digit);
+        }
+        changed = true;
+        tech_count[XY_CHAIN]++;
     }
-    
+
     return changed;
-}
\ No newline at end of file
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
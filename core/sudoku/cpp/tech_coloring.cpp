@@ -1,282 +1,49 @@
 #include "solver.h"
+#include "bitslice.h"
 #include <algorithm>
+#include <bit>
 #include <vector>
 
-bool SudokuSolver::findSingleColoring() {
-    bool changed = false;
-    
-    // Try each digit
-    for (int digit = 1; digit <= 9; digit++) {
-        // Try each cell where digit is a candidate
-        for (int r = 0; r < 9; r++) {
-            for (int c = 0; c < 9; c++) {
-                if (grid[r][c] != 0 || !candidates[r][c][digit]) continue;
-                
-                // Test hypothesis: digit at (r,c)
-                if (testColoringHypothesis(r, c, digit)) {
-                    // Found contradiction - eliminate candidate
-                    candidates[r][c][digit] = 0;
-                    changed = true;
-                    tech_count[SINGLE_COLORING]++;
-                }
-            }
-        }
-    }
-    
-    return changed;
-}
+// Single Coloring: assume each candidate of a digit in turn and propagate
+// that digit's singles; an assumption that reaches a contradiction is
+// false. Up to 64 assumptions share one bit-sliced kernel call, and all of
+// them are evaluated against the board as it was on entry.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findSingleColoring() {
+    const auto masks = cellMasks();
+    const SlicedBoard<Geo> board(masks);
 
-bool SudokuSolver::testColoringHypothesis(int hr, int hc, int digit) {
-    // Create copies of current state
-    auto gridCopy = grid;
-    auto candidatesCopy = candidates;
-    
-    // Set hypothesis cell
-    gridCopy[hr][hc] = digit;
-    candidatesCopy[hr][hc].reset();
-    
-    // Eliminate from groups containing hypothesis cell
-    for (int i = 0; i < 9; i++) {
-        if (i != hc) candidatesCopy[hr][i][digit] = 0;  // Row
-        if (i != hr) candidatesCopy[i][hc][digit] = 0;  // Column
-    }
-    
-    // Box elimination
-    int br = (hr/3)*3, bc = (hc/3)*3;
-    for (int i = 0; i < 3; i++) {
-        for (int j = 0; j < 3; j++) {
-            if (br+i != hr || bc+j != hc) {
-                candidatesCopy[br+i][bc+j][digit] = 0;
-            }
+    // Try each digit; digits are independent and may run in parallel
+    std::vector<std::vector<int>> dead(N + 1);
+    forEachParallel(N, [&](int i) {
+        const int digit = i + 1;
+        std::vector<int> cells;
+        for (int cell = 0; cell < Geo::NN; cell++) {
+            if (grid[cell / N][cell % N] == 0 && (masks[cell] >> digit & 1))
+                cells.push_back(cell);
         }
-    }
-    
-    // Propagate using single-digit techniques
-    bool changed = true;
-    while (changed) {
-        changed = false;
-        
-        // Check for contradictions first
-        if (hasContradiction(gridCopy, candidatesCopy, digit)) {
-            return true;  // Hypothesis leads to contradiction
-        }
-        
-        // Naked singles for this digit
-        for (int r = 0; r < 9; r++) {
-            for (int c = 0; c < 9; c++) {
-                if (gridCopy[r][c] == 0 && candidatesCopy[r][c].count() == 1 && candidatesCopy[r][c][digit]) {
-                    // Place digit
-                    gridCopy[r][c] = digit;
-                    candidatesCopy[r][c].reset();
-                    
-                    // Eliminate from groups
-                    for (int i = 0; i < 9; i++) {
-                        if (i != c) candidatesCopy[r][i][digit] = 0;
-                        if (i != r) candidatesCopy[i][c][digit] = 0;
-                    }
-                    
-                    int boxR = (r/3)*3, boxC = (c/3)*3;
-                    for (int i = 0; i < 3; i++) {
-                        for (int j = 0; j < 3; j++) {
-                            if (boxR+i != r || boxC+j != c) {
-                                candidatesCopy[boxR+i][boxC+j][digit] = 0;
-                            }
-                        }
-                    }
-                    
-                    changed = true;
-                }
-            }
-        }
-        
-        // Hidden singles for this digit
-        // Check rows
-        for (int r = 0; r < 9; r++) {
-            int count = 0, lastC = -1;
-            bool hasDigit = false;
-            
-            for (int c = 0; c < 9; c++) {
-                if (gridCopy[r][c] == digit) {
-                    hasDigit = true;
-                    break;
-                }
-                if (gridCopy[r][c] == 0 && candidatesCopy[r][c][digit]) {
-                    count++;
-                    lastC = c;
-                }
-            }
-            
-            if (!hasDigit && count == 1) {
-                // Place digit
-                gridCopy[r][lastC] = digit;
-                candidatesCopy[r][lastC].reset();
-                
-                // Eliminate from column and box
-                for (int i = 0; i < 9; i++) {
-                    if (i != r) candidatesCopy[i][lastC][digit] = 0;
-                }
-                
-                int boxR = (r/3)*3, boxC = (lastC/3)*3;
-                for (int i = 0; i < 3; i++) {
-                    for (int j = 0; j < 3; j++) {
-                        if (boxR+i != r || boxC+j != lastC) {
-                            candidatesCopy[boxR+i][boxC+j][digit] = 0;
-                        }
-                    }
-                }
-                
-                changed = true;
-            }
-        }
-        
-        // Check columns
-        for (int c = 0; c < 9; c++) {
-            int count = 0, lastR = -1;
-            bool hasDigit = false;
-            
-            for (int r = 0; r < 9; r++) {
-                if (gridCopy[r][c] == digit) {
-                    hasDigit = true;
-                    break;
-                }
-                if (gridCopy[r][c] == 0 && candidatesCopy[r][c][digit]) {
-                    count++;
-                    lastR = r;
-                }
-            }
-            
-            if (!hasDigit && count == 1) {
-                // Place digit
-                gridCopy[lastR][c] = digit;
-                candidatesCopy[lastR][c].reset();
-                
-                // Eliminate from row and box
-                for (int i = 0; i < 9; i++) {
-                    if (i != c) candidatesCopy[lastR][i][digit] = 0;
-                }
-                
-                int boxR = (lastR/3)*3, boxC = (c/3)*3;
-                for (int i = 0; i < 3; i++) {
-                    for (int j = 0; j < 3; j++) {
-                        if (boxR+i != lastR || boxC+j != c) {
-                            candidatesCopy[boxR+i][boxC+j][digit] = 0;
-                        }
-                    }
-                }
-                
-                changed = true;
-            }
+
+        // Test hypotheses 64 at a time: lane k assumes digit at cells[base + k]
+        for (size_t base = 0; base < cells.size(); base += 64) {
+            const int count = std::min<size_t>(64, cells.size() - base);
+            SlicedBoard<Geo> trial = board;
+            for (int k = 0; k < count; k++) trial.assume(k, cells[base + k], digit);
+
+            uint64_t lanes = count == 64 ? ~uint64_t(0) : (uint64_t(1) << count) - 1;
+            for (uint64_t out = trial.propagate(Word(1) << digit, lanes); out; out &= out - 1)
+                dead[digit].push_back(cells[base + std::countr_zero(out)]);
         }
-        
-        // Check boxes
-        for (int box = 0; box < 9; box++) {
-            int boxR = (box/3)*3, boxC = (box%3)*3;
-            int count = 0, lastR = -1, lastC = -1;
-            bool hasDigit = false;
-            
-            for (int i = 0; i < 3; i++) {
-                for (int j = 0; j < 3; j++) {
-                    int r = boxR + i, c = boxC + j;
-                    if (gridCopy[r][c] == digit) {
-                        hasDigit = true;
-                        break;
-                    }
-                    if (gridCopy[r][c] == 0 && candidatesCopy[r][c][digit]) {
-                        count++;
-                        lastR = r;
-                        lastC = c;
-                    }
-                }
-                if (hasDigit) break;
-            }
-            
-            if (!hasDigit && count == 1) {
-                // Place digit
-                gridCopy[lastR][lastC] = digit;
-                candidatesCopy[lastR][lastC].reset();
-                
-                // Eliminate from row and column
-                for (int i = 0; i < 9; i++) {
-                    if (i != lastC) candidatesCopy[lastR][i][digit] = 0;
-                    if (i != lastR) candidatesCopy[i][lastC][digit] = 0;
-                }
-                
-                changed = true;
-            }
+    });
+    // Found contradictions - eliminate candidates
+    bool changed = false;
+    for (int digit = 1; digit <= N; digit++) {
+        for (int cell : dead[digit]) {
+            removeCandidate(cell / N, cell % N, digit);
+            tech_count[SINGLE_COLORING]++;
+            changed = true;
         }
     }
-    
-    // Final contradiction check
-    return hasContradiction(gridCopy, candidatesCopy, digit);
+    return changed;
 }
 
-bool SudokuSolver::hasContradiction(const std::vector<std::vector<int>>& gridCopy,
-                                   const std::vector<std::vector<std::bitset<10>>>& candidatesCopy,
-                                   int digit) {
-    // Check rows
-    for (int r = 0; r < 9; r++) {
-        bool hasDigit = false;
-        bool hasCandidate = false;
-        
-        for (int c = 0; c < 9; c++) {
-            if (gridCopy[r][c] == digit) {
-                hasDigit = true;
-                break;
-            }
-            if (gridCopy[r][c] == 0 && candidatesCopy[r][c][digit]) {
-                hasCandidate = true;
-            }
-        }
-        
-        if (!hasDigit && !hasCandidate) {
-            return true;  // No place for digit in this row
-        }
-    }
-    
-    // Check columns
-    for (int c = 0; c < 9; c++) {
-        bool hasDigit = false;
-        bool hasCandidate = false;
-        
-        for (int r = 0; r < 9; r++) {
-            if (gridCopy[r][c] == digit) {
-                hasDigit = true;
-                break;
-            }
-            if (gridCopy[r][c] == 0 && candidatesCopy[r][c][digit]) {
-                hasCandidate = true;
-            }
-        }
-        
-        if (!hasDigit && !hasCandidate) {
-            return true;  // No place for digit in this column
-        }
-    }
-    
-    // Check boxes
-    for (int box = 0; box < 9; box++) {
-        int boxR = (box/3)*3, boxC = (box%3)*3;
-        bool hasDigit = false;
-        bool hasCandidate = false;
-        
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
-                int r = boxR + i, c = boxC + j;
-                if (gridCopy[r][c] == digit) {
-                    hasDigit = true;
-                    break;
-                }
-                if (gridCopy[r][c] == 0 && candidatesCopy[r][c][digit]) {
-                    hasCandidate = true;
-                }
-            }
-            if (hasDigit) break;
-        }
-        
-        if (!hasDigit && !hasCandidate) {
-            return true;  // No place for digit in this box
-        }
-    }
-    
-    return false;  // No contradiction found
-}
\ No newline at end of file
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
@@ -0,0 +1,246 @@
+#include "solver.h"
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <vector>
+
+namespace {
+
+// Set of (cell, digit) nodes, 729 bits on a 9x9 board
+template<int NODES>
+struct CandSet {
+    static constexpr int WORDS = (NODES + 63) / 64;
+    std::array<uint64_t, WORDS> w{};
+
+    void set(int i) { w[i >> 6] |= uint64_t(1) << (i & 63); }
+    bool test(int i) const { return (w[i >> 6] >> (i & 63)) & 1; }
+    bool any() const {
+        uint64_t acc = 0;
+        for (auto x : w) acc |= x;
+        return acc != 0;
+    }
+    CandSet& operator|=(const CandSet& o) {
+        for (int i = 0; i < WORDS; i++) w[i] |= o.w[i];
+        return *this;
+    }
+    CandSet& operator&=(const CandSet& o) {
+        for (int i = 0; i < WORDS; i++) w[i] &= o.w[i];
+        return *this;
+    }
+    CandSet operator&(const CandSet& o) const { CandSet r = *this; return r &= o; }
+    CandSet without(const CandSet& o) const {
+        CandSet r;
+        for (int i = 0; i < WORDS; i++) r.w[i] = w[i] & ~o.w[i];
+        return r;
+    }
+    template<typename Func>
+    void forEach(Func func) const {
+        for (int i = 0; i < WORDS; i++)
+            for (uint64_t x = w[i]; x; x &= x - 1) func(i * 64 + std::countr_zero(x));
+    }
+};
+
+// Implications between candidates: on(x) => off(y) for weak links (same
+// cell, or same digit in a shared house) and off(x) => on(y) for strong
+// links (bivalue cell, or the only two places for a digit in a house)
+template<int NODES>
+struct ImplicationGraph {
+    using Set = CandSet<NODES>;
+
+    std::vector<Set> weak;
+    std::vector<std::array<short, 4>> strong;
+    std::vector<unsigned char> strongCount;
+
+    ImplicationGraph() : weak(NODES), strong(NODES), strongCount(NODES, 0) {}
+
+    void addStrong(int x, int y) {
+        if (strongCount[x] < 4) strong[x][strongCount[x]++] = y;
+    }
+
+    // Expand newly false literals in `frontier` to a fixpoint. Returns false
+    // as soon as some candidate is forced both true and false.
+    bool close(Set& on, Set& off, Set frontier) const {
+        while (frontier.any()) {
+            Set newOn;
+            frontier.forEach([&](int y) {
+                for (int k = 0; k < strongCount[y]; k++) newOn.set(strong[y][k]);
+            });
+            newOn = newOn.without(on);
+            if ((newOn & off).any()) return false;
+            on |= newOn;
+
+            Set newOff;
+            newOn.forEach([&](int z) { newOff |= weak[z]; });
+            if ((newOff & on).any()) return false;
+            frontier = newOff.without(off);
+            off |= frontier;
+        }
+        return true;
+    }
+};
+
+} // namespace
+
+// Nice loops, AICs and forcing chains from one pass over the implication
+// graph. For every candidate x the closures of "x true" and "x false" are
+// computed with one bit per candidate; eliminations follow from contradictions
+// (discontinuous loops), from both branches agreeing (AIC, continuous loops,
+// digit forcing) and from all candidates of a cell or a house agreeing.
+// Boards above 16x16 are skipped: the dense rows would need ~100 MB.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findNiceLoops() {
+    if constexpr (N > 16) return false;
+    constexpr int NODES = Geo::NN * N;   // one node per (cell, digit)
+    using CandSet = ::CandSet<NODES>;
+    auto node = [](int cell, int n) { return cell * N + n - 1; };
+
+    const auto& geo = Geo::get();
+    ImplicationGraph<NODES> g;
+    CandSet live;
+
+    // Candidate masks and digit positions come from the candidate index
+    const auto& mask = index.mask;
+    const auto& positions = index.positions;
+    for (int cell = 0; cell < Geo::NN; cell++)
+        for (Word w = mask[cell]; w; w &= w - 1) live.set(node(cell, std::countr_zero(w)));
+
+    // Weak links
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        for (int n = 1; n <= N; n++) {
+            if (!(mask[cell] & (Word(1) << n))) continue;
+            auto& row = g.weak[node(cell, n)];
+            for (int m = 1; m <= N; m++)
+                if (m != n && (mask[cell] & (Word(1) << m))) row.set(node(cell, m));
+            for (int peer : geo.peers[cell])
+                if (positions[n][peer]) row.set(node(peer, n));
+        }
+        if (index.bivalue[cell]) {
+            int a = std::countr_zero(mask[cell]);
+            int b = std::bit_width(mask[cell]) - 1;
+            g.addStrong(node(cell, a), node(cell, b));
+            g.addStrong(node(cell, b), node(cell, a));
+        }
+    }
+
+    // Strong links inside houses
+    for (int h = 0; h < Geo::HOUSES; h++) {
+        for (int n = 1, a, b; n <= N; n++) {
+            if (!index.conjugate(h, n, a, b)) continue;
+            g.addStrong(node(a, n), node(b, n));
+            g.addStrong(node(b, n), node(a, n));
+        }
+    }
+
+    // Closures of "x true" for every candidate; a contradictory x is false
+    // and stays neutral (everything) in the cell and house intersections
+    std::vector<CandSet> forcedOn(NODES), forcedOff(NODES);
+    CandSet eliminated, placed;
+    auto record = [&](CandSet& total, const CandSet& found, Tech tech) {
+        CandSet fresh = found.without(total);
+        if (!fresh.any()) return;
+        total |= fresh;
+        tech_count[tech]++;
+    };
+
+    // Both branches of every candidate are independent of each other, so
+    // they are closed first (in parallel with a pool) and recorded in order
+    struct Outcome {
+        enum { TRUE_FAILS, FALSE_FAILS, BOTH_HOLD } kind;
+        bool loop;
+        CandSet both, agree;   // forced off / on by both branches
+    };
+    std::vector<int> nodes;
+    live.forEach([&](int x) { nodes.push_back(x); });
+    std::vector<Outcome> outcomes(nodes.size());
+    forEachParallel(nodes.size(), [&](int i) {
+        const int x = nodes[i];
+        auto& out = outcomes[i];
+        CandSet single;
+        single.set(x);
+
+        CandSet onT = single, offT = g.weak[x];
+        if (!g.close(onT, offT, g.weak[x])) {
+            forcedOn[x] = forcedOff[x] = live;
+            out.kind = Outcome::TRUE_FAILS;
+            return;
+        }
+        forcedOn[x] = onT;
+        forcedOff[x] = offT;
+
+        CandSet onF, offF = single;
+        if (!g.close(onF, offF, single)) {
+            out.kind = Outcome::FALSE_FAILS;
+            return;
+        }
+
+        // Both branches agree: eliminations seeing x are AIC (a continuous
+        // loop when a longer chain closes back onto a weak partner of x),
+        // the rest digit forcing
+        CandSet partners;
+        for (int k = 0; k < g.strongCount[x]; k++) partners.set(g.strong[x][k]);
+        out.kind = Outcome::BOTH_HOLD;
+        out.loop = (onF & g.weak[x]).without(partners).any();
+        out.both = offT & offF;
+        out.agree = onT & onF;
+    });
+
+    for (size_t i = 0; i < nodes.size(); i++) {
+        const int x = nodes[i];
+        const auto& out = outcomes[i];
+        CandSet single;
+        single.set(x);
+        if (out.kind == Outcome::TRUE_FAILS) {
+            record(eliminated, single, DISCONTINUOUS_NICE_LOOP);
+        } else if (out.kind == Outcome::FALSE_FAILS) {
+            record(placed, single, DISCONTINUOUS_NICE_LOOP);
+        } else {
+            record(eliminated, out.both & g.weak[x], out.loop ? CONTINUOUS_NICE_LOOP : AIC);
+            record(eliminated, out.both, DIGIT_FORCING_CHAIN);
+            record(placed, out.agree, DIGIT_FORCING_CHAIN);
+        }
+    }
+
+    // Cell forcing: every candidate of a cell implies the same thing
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        if (std::popcount(mask[cell]) < 2) continue;
+        CandSet on = live, off = live;
+        for (int n = 1; n <= N; n++) {
+            if (!(mask[cell] & (Word(1) << n))) continue;
+            on &= forcedOn[node(cell, n)];
+            off &= forcedOff[node(cell, n)];
+        }
+        record(eliminated, off, CELL_FORCING_CHAIN);
+        record(placed, on, CELL_FORCING_CHAIN);
+    }
+
+    // Unit forcing: every place for a digit in a house implies the same thing
+    for (int h = 0; h < Geo::HOUSES; h++) {
+        for (int n = 1; n <= N; n++) {
+            if (index.count(h, n) < 2) continue;
+            CandSet on = live, off = live;
+            for (auto p = index.places[h][n]; p; p &= p - 1) {
+                const int cell = geo.houseCells[h][std::countr_zero(p)];
+                on &= forcedOn[node(cell, n)];
+                off &= forcedOff[node(cell, n)];
+            }
+            record(eliminated, off, UNIT_FORCING_CHAIN);
+            record(placed, on, UNIT_FORCING_CHAIN);
+        }
+    }
+
+    bool changed = false;
+    eliminated.forEach([&](int x) {
+        int cell = x / N;
+        changed |= removeCandidate(cell / N, cell % N, x % N + 1);
+    });
+    placed.forEach([&](int x) {
+        int cell = x / N, r = cell / N, c = cell % N, n = x % N + 1;
+        if (grid[r][c] == 0 && candidates[r][c][n]) {
+            setCell(r, c, n);
+            changed = true;
+        }
+    });
+    return changed;
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
@@ -0,0 +1,119 @@
+#include "solver.h"
+#include <array>
+#include <bit>
+#include <utility>
+
+// Chute tables: the cells of every box on each of its rows and columns.
+// A band is a row of boxes, a stack a column of boxes; both are chutes.
+template<typename Geo>
+struct ChuteTables {
+    static constexpr int N = Geo::N;
+    using CellSet = typename Geo::CellSet;
+
+    std::array<std::array<CellSet, N>, N> rowSegment{};   // [box][row]: box cells on the row
+    std::array<std::array<CellSet, N>, N> colSegment{};   // [box][col]: box cells on the column
+
+    ChuteTables() {
+        for (int cell = 0; cell < Geo::NN; cell++) {
+            const int r = cell / N, c = cell % N, b = Geo::box(r, c);
+            rowSegment[b][r][cell] = 1;
+            colSegment[b][c][cell] = 1;
+        }
+    }
+
+    static const ChuteTables& get() {
+        static const ChuteTables tables;
+        return tables;
+    }
+};
+
+// Rectangle Elimination: a candidate n in cell c that sees one end b of a
+// strong link on n is false if c and the other end a, both n, would leave
+// n no place in some box
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findRectangleElimination() {
+    const auto& geo = Geo::get();
+    bool changed = false;
+
+    for (int n = 1; n <= N; n++) {
+        // Boxes where n is open, with its places there
+        int boxes[N], open = 0;
+        std::array<CellSet, N> inBox;
+        for (int box = 0; box < N; box++) {
+            if (!index.places[2 * N + box][n]) continue;
+            inBox[open] = index.positions[n] & geo.houseMask[2 * N + box];
+            boxes[open++] = box;
+        }
+        for (int h = 0; h < Geo::HOUSES; h++) {
+            int ends[2];
+            if (!index.conjugate(h, n, ends[0], ends[1])) continue;
+            for (int k = 0; k < 2; k++) {
+                const int a = ends[k], b = ends[1 - k];
+                const int boxA = geo.houseOf[a][2] - 2 * N;
+                for (int c : geo.peers[b]) {
+                    if (c == a || !index.positions[n][c] || geo.peerMask[a][c]) continue;
+                    const int boxC = geo.houseOf[c][2] - 2 * N;
+                    for (int i = 0; i < open; i++) {
+                        if (boxes[i] == boxA || boxes[i] == boxC) continue;
+                        if ((inBox[i] & ~geo.peerMask[a] & ~geo.peerMask[c]).none()) {
+                            removeCandidate(c / N, c % N, n);
+                            tech_count[RECTANGLE_ELIM]++;
+                            changed = true;
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+// Chute Remote Pairs: two bivalue cells {x,y} in one chute, in different
+// boxes and lines. Were both x, the other boxes of the chute would need x
+// on their remaining lines; a box whose x (candidate or value) lies only
+// on the pair's lines rules that out, so one of them is y and y goes from
+// the cells that see both.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findChuteRemotePairs() {
+    const auto& geo = Geo::get();
+    const auto& chutes = ChuteTables<Geo>::get();
+    bool changed = false;
+
+    // Cells that hold or may hold each digit
+    std::array<CellSet, N + 1> holds = index.positions;
+    for (int cell = 0; cell < Geo::NN; cell++)
+        if (grid[cell / N][cell % N]) holds[grid[cell / N][cell % N]][cell] = 1;
+
+    for (int a = 0; a < Geo::NN; a++) {
+        if (!index.bivalue[a]) continue;
+        const int x = std::countr_zero(index.mask[a]), y = std::bit_width(index.mask[a]) - 1;
+        const int ra = a / N, ca = a % N, boxA = Geo::box(ra, ca);
+        for (int b = a + 1; b < Geo::NN; b++) {
+            if (!index.pairCells[x][y][b] || index.mask[a] != index.mask[b]) continue;
+            const int rb = b / N, cb = b % N, boxB = Geo::box(rb, cb);
+            if (boxA == boxB || geo.peerMask[a][b]) continue;
+
+            // The chute they share, and the segments of its other boxes on their lines
+            const bool band = ra / BR == rb / BR;
+            if (!band && ca / BC != cb / BC) continue;
+            const CellSet targets = geo.peerMask[a] & geo.peerMask[b];
+            for (int box = 0; box < N; box++) {
+                if (box == boxA || box == boxB) continue;
+                if (band ? Geo::boxRow(box) != Geo::boxRow(boxA) : Geo::boxCol(box) != Geo::boxCol(boxA)) continue;
+                const CellSet lines = band ? chutes.rowSegment[box][ra] | chutes.rowSegment[box][rb]
+                                           : chutes.colSegment[box][ca] | chutes.colSegment[box][cb];
+                for (auto [d, other] : {std::pair(x, y), std::pair(y, x)}) {
+                    if ((holds[d] & geo.houseMask[2 * N + box] & ~lines).any()) continue;
+                    if (eliminateFromCells(targets & index.positions[other], other)) {
+                        tech_count[CHUTE_REMOTE_PAIR]++;
+                        changed = true;
+                    }
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
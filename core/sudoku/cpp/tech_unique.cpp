@@ -0,0 +1,170 @@
+#include "solver.h"
+#include <algorithm>
+#include <bit>
+#include <utility>
+
+// Uniqueness techniques. They assume the puzzle has one solution: digits
+// x and y on the four corners of a rectangle that spans two boxes (a
+// deadly pattern) could be swapped into a second one, so some candidate
+// that would complete the pattern is false. All of them read the
+// candidate index: bivalue cells by digit pair find the rectangles and
+// per-house places give the conjugate pairs.
+
+// Rectangles with a bivalue corner a = (r1,c1); b = (r1,c2), c = (r2,c1)
+// and d = (r2,c2) must hold both of a's digits
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findUniqueRectangles() {
+    bool changed = false;
+    for (int a = 0; a < Geo::NN; a++) {
+        if (!index.bivalue[a]) continue;
+        const int x = std::countr_zero(index.mask[a]), y = std::bit_width(index.mask[a]) - 1;
+        const CellSet both = index.positions[x] & index.positions[y];
+        const int r1 = a / N, c1 = a % N;
+        for (int c2 = 0; c2 < N; c2++) {
+            if (c2 == c1 || !both[r1 * N + c2]) continue;
+            for (int r2 = 0; r2 < N; r2++) {
+                if (r2 == r1 || !both[r2 * N + c1] || !both[r2 * N + c2]) continue;
+                if ((r1 / BR == r2 / BR) == (c1 / BC == c2 / BC)) continue;   // not two boxes
+                changed |= checkRectangle(a, r1 * N + c2, r2 * N + c1, r2 * N + c2, x, y);
+            }
+        }
+    }
+    return changed;
+}
+
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::checkRectangle(int a, int b, int c, int d, int x, int y) {
+    const Word xy = Word(Word(1) << x | Word(1) << y);
+    const int corners[4] = {a, b, c, d};
+    int floor = 0;   // corners holding just x and y, bit k for corners[k]
+    for (int k = 0; k < 4; k++) {
+        if ((index.mask[corners[k]] & xy) != xy) return false;   // changed by an earlier rectangle
+        if (index.mask[corners[k]] == xy) floor |= 1 << k;
+    }
+    if (!(floor & 1)) return false;
+
+    // Type 1: three corners are bivalue, the fourth can't be x or y
+    if (std::popcount(unsigned(floor)) == 3) {
+        const int f = corners[std::countr_zero(unsigned(~floor & 15))];
+        removeCandidate(f / N, f % N, x);
+        removeCandidate(f / N, f % N, y);
+        tech_count[UNIQUE_RECT_1]++;
+        return true;
+    }
+    // Types 2-4: a bivalue side, the roof opposite it shares a row or column
+    if (floor == 3 && checkRectangleRoof(c, d, x, y)) return true;
+    if (floor == 5 && checkRectangleRoof(b, d, x, y)) return true;
+
+    // Hidden rectangle: if x only lies on the rectangle in d's row and
+    // column, d = y would force x into b and c and y into a
+    bool changed = false;
+    for (auto [p, q] : {std::pair(x, y), std::pair(y, x)}) {
+        if (index.count(d / N, p) == 2 && index.count(N + d % N, p) == 2 && removeCandidate(d / N, d % N, q)) {
+            tech_count[HIDDEN_UNIQUE_RECT]++;
+            changed = true;
+            break;
+        }
+    }
+    return changed;
+}
+
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::checkRectangleRoof(int p, int q, int x, int y) {
+    const auto& geo = Geo::get();
+    const Word xy = Word(Word(1) << x | Word(1) << y);
+    const Word extra = Word((index.mask[p] | index.mask[q]) & ~xy);   // one of them is placed in a roof cell
+
+    // Type 2: both roof cells have the same one extra digit z, which is placed in one of them
+    if ((index.mask[p] & ~xy) == extra && (index.mask[q] & ~xy) == extra && std::popcount(extra) == 1) {
+        const int z = std::countr_zero(extra);
+        if (eliminateFromCells(geo.peerMask[p] & geo.peerMask[q] & index.positions[z], z)) {
+            tech_count[UNIQUE_RECT_2]++;
+            return true;
+        }
+    }
+
+    for (int h : geo.houseOf[p]) {
+        if (!geo.houseMask[h][q]) continue;
+
+        // Type 4: x only lies on the roof in a house, so y is in neither roof cell
+        for (auto [s, t] : {std::pair(x, y), std::pair(y, x)}) {
+            if (index.count(h, s) != 2) continue;
+            bool changed = removeCandidate(p / N, p % N, t);
+            changed |= removeCandidate(q / N, q % N, t);
+            if (changed) {
+                tech_count[UNIQUE_RECT_4]++;
+                return true;
+            }
+        }
+
+        // Type 3: the roof acts as one cell holding the extra digits; with
+        // k other cells of the house it forms a naked set of k + 1 digits
+        if (std::popcount(extra) > 3) continue;
+        int cells[N], count = 0;
+        for (int cell : geo.houseCells[h])
+            if (cell != p && cell != q && index.mask[cell] && std::popcount(Word(index.mask[cell] | extra)) <= 4)
+                cells[count++] = cell;
+        int chosen[3];
+        auto extend = [&](auto& self, int from, int size, Word digits) -> bool {
+            if (size && std::popcount(digits) == size + 1) {
+                bool changed = false;
+                for (int cell : geo.houseCells[h]) {
+                    if (cell == p || cell == q || !(index.mask[cell] & digits)) continue;
+                    if (std::find(chosen, chosen + size, cell) != chosen + size) continue;
+                    changed |= keepCandidates(cell / N, cell % N, Mask(Word(~digits)));
+                }
+                return changed;
+            }
+            if (size == 3) return false;
+            for (int i = from; i < count; i++) {
+                chosen[size] = cells[i];
+                const Word next = Word(digits | index.mask[cells[i]]);
+                if (std::popcount(next) <= 4 && self(self, i + 1, size + 1, next)) return true;
+            }
+            return false;
+        };
+        if (extend(extend, 0, 0, extra)) {
+            tech_count[UNIQUE_RECT_3]++;
+            return true;
+        }
+    }
+    return false;
+}
+
+// BUG+1: if every open cell but one is bivalue and every digit has two
+// places in each house where it is open, each digit would fill its houses
+// in one of two ways, a second solution. The one trivalue cell breaks it
+// with the digit that has three places in each of its houses. Both counts
+// are checked so that the step stays sound when run before Hidden Singles.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findBivalueGrave() {
+    int extra = -1;
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        const int count = std::popcount(index.mask[cell]);
+        if (count == 0 || count == 2) continue;
+        if (count != 3 || extra >= 0) return false;
+        extra = cell;
+    }
+    if (extra < 0) return false;
+
+    const auto& houses = Geo::get().houseOf[extra];
+    int n = 0;
+    for (Word w = index.mask[extra]; w && !n; w &= w - 1) {
+        const int d = std::countr_zero(w);
+        if (index.count(houses[0], d) == 3 && index.count(houses[1], d) == 3 && index.count(houses[2], d) == 3) n = d;
+    }
+    if (!n) return false;
+    for (int h = 0; h < Geo::HOUSES; h++) {
+        const bool own = std::find(houses.begin(), houses.end(), h) != houses.end();
+        for (int d = 1; d <= N; d++) {
+            const int count = index.count(h, d);
+            if (count && count != 2 && !(own && d == n)) return false;
+        }
+    }
+
+    keepCandidates(extra / N, extra % N, Mask(Word(Word(1) << n)));
+    tech_count[BIVALUE_GRAVE]++;
+    return true;
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
@@ -1,30 +1,34 @@
 #include "solver.h"
 #include <algorithm>
+#include <array>
+#include <bit>
 
 // Check if two cells can see each other (same row, col, or box)
-bool SudokuSolver::canSee(int r1, int c1, int r2, int c2) const {
-    return r1 == r2 || c1 == c2 || ((r1/3) == (r2/3) && (c1/3) == (c2/3));
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::canSee(int r1, int c1, int r2, int c2) const {
+    return r1 == r2 || c1 == c2 || ((r1/BR) == (r2/BR) && (c1/BC) == (c2/BC));
 }
 
 // X-Wing: Find rectangle pattern for candidate elimination
-bool SudokuSolver::findXWing() {
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findXWing() {
     bool changed = false;
     
     // Try each candidate number
-    for (int n = 1; n <= 9; n++) {
+    for (int n = 1; n <= N; n++) {
         // Check rows
-        for (int r1 = 0; r1 < 8; r1++) {
+        for (int r1 = 0; r1 < N - 1; r1++) {
             std::vector<int> cols1;
-            for (int c = 0; c < 9; c++) {
+            for (int c = 0; c < N; c++) {
                 if (grid[r1][c] == 0 && candidates[r1][c][n])
                     cols1.push_back(c);
             }
             if (cols1.size() != 2) continue;
             
             // Find matching row
-            for (int r2 = r1 + 1; r2 < 9; r2++) {
+            for (int r2 = r1 + 1; r2 < N; r2++) {
                 std::vector<int> cols2;
-                for (int c = 0; c < 9; c++) {
+                for (int c = 0; c < N; c++) {
                     if (grid[r2][c] == 0 && candidates[r2][c][n])
                         cols2.push_back(c);
                 }
@@ -32,13 +36,10 @@ bool SudokuSolver::findXWing() {
                 // Check if same columns
                 if (cols2.size() == 2 && cols1[0] == cols2[0] && cols1[1] == cols2[1]) {
                     // Found X-Wing, eliminate from columns
-                    for (int r = 0; r < 9; r++) {
+                    for (int r = 0; r < N; r++) {
                         if (r != r1 && r != r2) {
                             for (int c : cols1) {
-                                if (grid[r][c] == 0 && candidates[r][c][n]) {
-                                    candidates[r][c][n] = 0;
-                                    changed = true;
-                                }
+                                if (grid[r][c] == 0 && removeCandidate(r, c, n)) changed = true;
                             }
                         }
                     }
@@ -48,17 +49,17 @@ bool SudokuSolver::findXWing() {
         }
         
         // Check columns (same logic, transposed)
-        for (int c1 = 0; c1 < 8; c1++) {
+        for (int c1 = 0; c1 < N - 1; c1++) {
             std::vector<int> rows1;
-            for (int r = 0; r < 9; r++) {
+            for (int r = 0; r < N; r++) {
                 if (grid[r][c1] == 0 && candidates[r][c1][n])
                     rows1.push_back(r);
             }
             if (rows1.size() != 2) continue;
             
-            for (int c2 = c1 + 1; c2 < 9; c2++) {
+            for (int c2 = c1 + 1; c2 < N; c2++) {
                 std::vector<int> rows2;
-                for (int r = 0; r < 9; r++) {
+                for (int r = 0; r < N; r++) {
                     if (grid[r][c2] == 0 && candidates[r][c2][n])
                         rows2.push_back(r);
                 }
@@ -66,13 +67,10 @@ bool SudokuSolver::findXWing() {
                 if (rows2.size() == 2 && rows1[0] == rows2[0] && rows1[1] == rows2[1]) {
                     // Found X-Wing, eliminate from rows
                     bool local_changed = false;
-                    for (int c = 0; c < 9; c++) {
+                    for (int c = 0; c < N; c++) {
                         if (c != c1 && c != c2) {
                             for (int r : rows1) {
-                                if (grid[r][c] == 0 && candidates[r][c][n]) {
-                                    candidates[r][c][n] = 0;
-                                    local_changed = true;
-                                }
+                                if (grid[r][c] == 0 && removeCandidate(r, c, n)) local_changed = true;
                             }
                         }
                     }
@@ -87,78 +85,125 @@ bool SudokuSolver::findXWing() {
     return changed;
 }
 
-// Y-Wing: Find bent triple pattern
-bool SudokuSolver::findYWing() {
+// Remove candidate n from a set of cells. Wings read candidate masks,
+// digit positions and bivalue cells by digit pair from the solver's
+// candidate index, which these removals keep current.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::eliminateFromCells(const CellSet& cells, int n) {
+    if (cells.none()) return false;
+    for (int cell = 0; cell < Geo::NN; cell++)
+        if (cells[cell]) removeCandidate(cell / N, cell % N, n);
+    return true;
+}
+
+// Y-Wing: bivalue pivot {x,y} with bivalue wings {x,z} and {y,z} among its peers
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findYWing() {
+    const auto& geo = Geo::get();
     bool changed = false;
-    
-    // Find all bi-value cells
-    std::vector<std::tuple<int, int, int, int>> biCells; // r, c, val1, val2
-    for (int r = 0; r < 9; r++) {
-        for (int c = 0; c < 9; c++) {
-            if (grid[r][c] == 0 && candidates[r][c].count() == 2) {
-                int v1 = 0, v2 = 0;
-                for (int n = 1; n <= 9; n++) {
-                    if (candidates[r][c][n]) {
-                        if (!v1) v1 = n;
-                        else v2 = n;
+
+    for (int p = 0; p < Geo::NN; p++) {
+        if (!index.bivalue[p]) continue;
+        int x = std::countr_zero(index.mask[p]);
+        int y = std::bit_width(index.mask[p]) - 1;
+
+        for (int z = 1; z <= N; z++) {
+            if (z == x || z == y) continue;
+            auto wings1 = index.pairCells[x][z] & geo.peerMask[p];
+            auto wings2 = index.pairCells[y][z] & geo.peerMask[p];
+            if (wings1.none() || wings2.none()) continue;
+
+            for (int w1 : geo.peers[p]) {
+                if (!wings1[w1]) continue;
+                for (int w2 : geo.peers[p]) {
+                    if (!wings2[w2]) continue;
+                    auto elim = geo.peerMask[w1] & geo.peerMask[w2] & index.positions[z];
+                    if (eliminateFromCells(elim, z)) {
+                        changed = true;
+                        tech_count[Y_WING]++;
                     }
                 }
-                biCells.push_back({r, c, v1, v2});
             }
         }
     }
-    
-    // Try each bi-value cell as pivot
-    for (size_t i = 0; i < biCells.size(); i++) {
-        auto [pr, pc, pv1, pv2] = biCells[i];
-        
-        // Find two wings that share one value each with pivot
-        for (size_t j = 0; j < biCells.size(); j++) {
-            if (i == j) continue;
-            auto [wr1, wc1, wv1, wv2] = biCells[j];
-            if (!canSee(pr, pc, wr1, wc1)) continue;
-            
-            // Check if shares exactly one value with pivot
-            int shared1 = 0;
-            if ((wv1 == pv1 || wv1 == pv2) && (wv2 != pv1 && wv2 != pv2)) shared1 = wv1;
-            else if ((wv2 == pv1 || wv2 == pv2) && (wv1 != pv1 && wv1 != pv2)) shared1 = wv2;
-            else continue;
-            
-            int other1 = (wv1 == shared1) ? wv2 : wv1;
-            
-            for (size_t k = j + 1; k < biCells.size(); k++) {
-                if (i == k) continue;
-                auto [wr2, wc2, wv3, wv4] = biCells[k];
-                if (!canSee(pr, pc, wr2, wc2)) continue;
-                
-                // Check if shares exactly one value with pivot
-                int shared2 = 0;
-                if ((wv3 == pv1 || wv3 == pv2) && (wv4 != pv1 && wv4 != pv2)) shared2 = wv3;
-                else if ((wv4 == pv1 || wv4 == pv2) && (wv3 != pv1 && wv3 != pv2)) shared2 = wv4;
-                else continue;
-                
-                if (shared1 == shared2) continue; // Must share different values
-                
-                int other2 = (wv3 == shared2) ? wv4 : wv3;
-                
-                // Check if wings share common value
-                if (other1 == other2) {
-                    // Found Y-Wing! Eliminate common value from cells seeing both wings
-                    bool local_changed = false;
-                    for (int r = 0; r < 9; r++) {
-                        for (int c = 0; c < 9; c++) {
-                            if (grid[r][c] == 0 && candidates[r][c][other1] &&
-                                canSee(r, c, wr1, wc1) && canSee(r, c, wr2, wc2) &&
-                                !(r == pr && c == pc) && !(r == wr1 && c == wc1) && !(r == wr2 && c == wc2)) {
-                                candidates[r][c][other1] = 0;
-                                local_changed = true;
+    return changed;
+}
+
+// XYZ-Wing: trivalue pivot {x,y,z} with bivalue wings {x,z} and {y,z} among its peers
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findXYZWing() {
+    const auto& geo = Geo::get();
+    bool changed = false;
+
+    for (int p = 0; p < Geo::NN; p++) {
+        if (!index.trivalue[p]) continue;
+
+        for (int z = 1; z <= N; z++) {
+            if (!(index.mask[p] & (Word(1) << z))) continue;
+            Word rest = index.mask[p] & ~(Word(1) << z);
+            int x = std::countr_zero(rest);
+            int y = std::bit_width(rest) - 1;
+
+            auto wings1 = index.pairCells[x][z] & geo.peerMask[p];
+            auto wings2 = index.pairCells[y][z] & geo.peerMask[p];
+            if (wings1.none() || wings2.none()) continue;
+
+            for (int w1 : geo.peers[p]) {
+                if (!wings1[w1]) continue;
+                for (int w2 : geo.peers[p]) {
+                    if (!wings2[w2]) continue;
+                    auto elim = geo.peerMask[p] & geo.peerMask[w1] & geo.peerMask[w2] & index.positions[z];
+                    if (eliminateFromCells(elim, z)) {
+                        changed = true;
+                        tech_count[XYZ_WING]++;
+                    }
+                }
+            }
+        }
+    }
+    return changed;
+}
+
+// W-Wing: two non-seeing bivalue cells {x,y} joined by a strong link on x
+// (one link end sees each cell); one of them must be y
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findWWing() {
+    const auto& geo = Geo::get();
+    bool changed = false;
+
+    // Strong links: the only two positions of a digit in some house
+    std::array<std::vector<std::pair<int, int>>, N + 1> links;
+    for (int n = 1; n <= N; n++) {
+        for (int h = 0, a, b; h < Geo::HOUSES; h++)
+            if (index.conjugate(h, n, a, b)) links[n].push_back({a, b});
+    }
+
+    for (int x = 1; x < N; x++) {
+        for (int y = x + 1; y <= N; y++) {
+            const auto& pairs = index.pairCells[x][y];
+            if (pairs.count() < 2) continue;
+            std::vector<int> cells;
+            for (int cell = 0; cell < Geo::NN; cell++)
+                if (pairs[cell]) cells.push_back(cell);
+
+            for (size_t i = 0; i < cells.size(); i++) {
+                for (size_t j = i + 1; j < cells.size(); j++) {
+                    int a = cells[i], b = cells[j];
+                    if (geo.peerMask[a][b]) continue;
+
+                    for (auto [link, other] : {std::pair{x, y}, std::pair{y, x}}) {
+                        for (auto [e1, e2] : links[link]) {
+                            if (e1 == a || e1 == b || e2 == a || e2 == b) continue;
+                            bool joined = (geo.peerMask[a][e1] && geo.peerMask[b][e2]) ||
+                                          (geo.peerMask[a][e2] && geo.peerMask[b][e1]);
+                            if (!joined) continue;
+                            auto elim = geo.peerMask[a] & geo.peerMask[b] & index.positions[other];
+                            if (eliminateFromCells(elim, other)) {
+                                changed = true;
+                                tech_count[W_WING]++;
                             }
                         }
                     }
-                    if (local_changed) {
-                        changed = true;
-                        tech_count[Y_WING]++;
-                    };
                 }
             }
         }
@@ -166,72 +211,84 @@ bool SudokuSolver::findYWing() {
     return changed;
 }
 
-// XYZ-Wing: Extended Y-Wing with tri-value pivot
-bool SudokuSolver::findXYZWing() {
+// WXYZ-Wing: a pivot and three peer wings holding exactly four digits, where
+// every digit but z is restricted (all its holders see each other). The four
+// cells cannot all be filled without z, so z goes from cells seeing every z holder.
+template<typename Geo>
+bool BasicSudokuSolver<Geo>::findWXYZWing() {
+    const auto& geo = Geo::get();
     bool changed = false;
-    
-    // Find all cells with exactly 3 candidates (pivots)
-    for (int pr = 0; pr < 9; pr++) {
-        for (int pc = 0; pc < 9; pc++) {
-            if (grid[pr][pc] || candidates[pr][pc].count() != 3) continue;
-            
-            // Find all bi-value cells that can see pivot
-            for (int r1 = 0; r1 < 9; r1++) {
-                for (int c1 = 0; c1 < 9; c1++) {
-                    if ((r1 == pr && c1 == pc) || grid[r1][c1]) continue;
-                    if (candidates[r1][c1].count() != 2 || !canSee(pr, pc, r1, c1)) continue;
-                    
-                    // Check if wing1 shares exactly 2 values with pivot
-                    auto shared1 = candidates[r1][c1] & candidates[pr][pc];
-                    if (shared1.count() != 2) continue;
-                    
-                    // Find second wing
-                    for (int r2 = 0; r2 < 9; r2++) {
-                        for (int c2 = 0; c2 < 9; c2++) {
-                            if ((r2 == pr && c2 == pc) || (r2 == r1 && c2 == c1)) continue;
-                            if (grid[r2][c2] || candidates[r2][c2].count() != 2) continue;
-                            if (!canSee(pr, pc, r2, c2)) continue;
-                            
-                            // Check if wing2 shares exactly 2 values with pivot
-                            auto shared2 = candidates[r2][c2] & candidates[pr][pc];
-                            if (shared2.count() != 2) continue;
-                            
-                            // Check that wings have exactly 1 common candidate
-                            auto common = candidates[r1][c1] & candidates[r2][c2];
-                            if (common.count() != 1) continue;
-                            
-                            // Check that together wings cover all pivot candidates
-                            if ((candidates[r1][c1] | candidates[r2][c2]) != candidates[pr][pc]) continue;
-                            
-                            // Extract common candidate
-                            int z = 0;
-                            for (int n = 1; n <= 9; n++) {
-                                if (common[n]) { z = n; break; }
-                            }
-                            
-                            // Found valid XYZ-Wing! Eliminate z from cells seeing all three
-                            bool local_changed = false;
-                            for (int r = 0; r < 9; r++) {
-                                for (int c = 0; c < 9; c++) {
-                                    if (grid[r][c] == 0 && candidates[r][c][z] &&
-                                        canSee(r, c, pr, pc) && canSee(r, c, r1, c1) && 
-                                        canSee(r, c, r2, c2) &&
-                                        !(r == pr && c == pc) && !(r == r1 && c == c1) && 
-                                        !(r == r2 && c == c2)) {
-                                        candidates[r][c][z] = 0;
-                                        local_changed = true;
+
+    for (int p = 0; p < Geo::NN; p++) {
+        int size = std::popcount(index.mask[p]);
+        if (size < 2 || size > 4) continue;
+
+        std::vector<int> pool;
+        for (int q : geo.peers[p]) {
+            int k = std::popcount(index.mask[q]);
+            if (k >= 2 && k <= 4) pool.push_back(q);
+        }
+        if (pool.size() < 3) continue;
+
+        // Every 4-digit set containing the pivot's candidates; digits are
+        // added in increasing order so each set is generated once
+        std::vector<std::pair<Word, int>> sets = {{index.mask[p], 1}};
+        for (int k = size; k < 4; k++) {
+            std::vector<std::pair<Word, int>> grown;
+            for (auto [set, next] : sets)
+                for (int n = next; n <= N; n++)
+                    if (!(set & (Word(1) << n))) grown.push_back({Word(set | (Word(1) << n)), n + 1});
+            sets.swap(grown);
+        }
+
+        for (auto [digits, next] : sets) {
+            std::vector<int> wings;
+            for (int q : pool)
+                if ((index.mask[q] & ~digits) == 0) wings.push_back(q);
+            if (wings.size() < 3) continue;
+
+            for (size_t i = 0; i < wings.size(); i++) {
+                for (size_t j = i + 1; j < wings.size(); j++) {
+                    for (size_t k = j + 1; k < wings.size(); k++) {
+                        const int cells[4] = {p, wings[i], wings[j], wings[k]};
+                        Word all = 0;
+                        for (int cell : cells) all |= index.mask[cell];
+                        if (all != digits) continue;
+
+                        // Find the single unrestricted digit
+                        int z = 0, unrestricted = 0;
+                        for (int n = 1; n <= N && unrestricted < 2; n++) {
+                            if (!(digits & (Word(1) << n))) continue;
+                            bool restricted = true;
+                            for (int a = 0; a < 4 && restricted; a++) {
+                                if (!(index.mask[cells[a]] & (Word(1) << n))) continue;
+                                for (int b = a + 1; b < 4; b++) {
+                                    if ((index.mask[cells[b]] & (Word(1) << n)) && !geo.peerMask[cells[a]][cells[b]]) {
+                                        restricted = false;
+                                        break;
                                     }
                                 }
                             }
-                            if (local_changed) {
-                                changed = true;
-                                tech_count[XYZ_WING]++;
+                            if (!restricted) {
+                                z = n;
+                                unrestricted++;
                             }
                         }
+                        if (unrestricted != 1) continue;
+
+                        auto elim = index.positions[z];
+                        for (int cell : cells)
+                            if (index.mask[cell] & (Word(1) << z)) elim &= geo.peerMask[cell];
+                        if (eliminateFromCells(elim, z)) {
+                            changed = true;
+                            tech_count[WXYZ_WING]++;
+                        }
                     }
                 }
             }
         }
     }
     return changed;
-}
\ No newline at end of file
+}
+
+SUDOKU_INSTANTIATE(BasicSudokuSolver)
@@ -0,0 +1,77 @@
+#include "trace.h"
+#include <format>
+#include <sstream>
+
+namespace {
+
+// Body of a JSON string: the puzzle line is user input and may hold
+// quotes, backslashes, control characters or bytes that are not UTF-8
+std::string escape(const std::string& text) {
+    std::string out;
+    for (unsigned char ch : text) {
+        if (ch == '"' || ch == '\\') out += {'\\', char(ch)};
+        else if (ch < 0x20 || ch >= 0x7f) out += std::format("\\u{:04x}", ch);
+        else out += char(ch);
+    }
+    return out;
+}
+
+} // namespace
+
+void TraceRecorder::beginPuzzle(const std::string& p) {
+    puzzle = p;
+    puzzleFirst = events.size();
+    // Placeholder for the puzzle span, filled in by endPuzzle so that it
+    // precedes its children in the file
+    events.push_back({});
+    puzzleStart = Clock::now();
+}
+
+double TraceRecorder::endPuzzle(bool solved) {
+    const auto end = Clock::now();
+    auto& e = events[puzzleFirst];
+    e.name = "puzzle";
+    e.cat = "puzzle";
+    e.ts = micros(puzzleStart);
+    e.dur = micros(end) - e.ts;
+    e.args = std::format(R"("puzzle": "{}", "solved": {})", escape(puzzle), solved);
+    return e.dur;
+}
+
+void TraceRecorder::endKernel(bool solved, int nakedSingles, int hiddenSingles) {
+    const double ts = micros(kernelStart);
+    events.push_back({"Singles kernel", "tier", ts, micros(Clock::now()) - ts,
+                      std::format(R"("solved": {}, "naked_singles": {}, "hidden_singles": {})",
+                                  solved, nakedSingles, hiddenSingles)});
+}
+
+void TraceRecorder::beginStep(int, const SolveProgress& progress) {
+    stepProgress = progress;
+    stepStart = Clock::now();
+}
+
+void TraceRecorder::endStep(int step, bool changed, const SolveProgress& progress) {
+    const double ts = micros(stepStart);
+    events.push_back({SolverBase::step_names[step], "step", ts, micros(Clock::now()) - ts,
+                      std::format(R"("changed": {}, "eliminated": {}, "placed": {})", changed,
+                                  progress.eliminated - stepProgress.eliminated,
+                                  progress.placed - stepProgress.placed)});
+}
+
+void TraceRecorder::write(std::ostream& out) const {
+    out << "{\"traceEvents\": [\n";
+    for (size_t i = 0; i < events.size(); i++) {
+        const auto& e = events[i];
+        out << std::format(R"(  {{"name": "{}", "cat": "{}", "ph": "X", "ts": {:.3f}, "dur": {:.3f}, )"
+                           R"("pid": 1, "tid": 1, "args": {{{}}}}})",
+                           e.name, e.cat, e.ts, e.dur, e.args)
+            << (i + 1 < events.size() ? ",\n" : "\n");
+    }
+    out << "], \"displayTimeUnit\": \"ms\"}\n";
+}
+
+std::string TraceRecorder::json() const {
+    std::ostringstream out;
+    write(out);
+    return out.str();
+}
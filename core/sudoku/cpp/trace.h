@@ -0,0 +1,50 @@
+#pragma once
+#include <chrono>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "solver.h"
+
+// Records solves as Chrome Trace Event JSON (chrome://tracing or
+// ui.perfetto.dev). Each puzzle is a span; the singles kernel and every
+// technique step of the full engine are spans nested inside it, with the
+// step's result and the candidates it removed and cells it set.
+class TraceRecorder : public SolveObserver {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    TraceRecorder() : origin(Clock::now()) {}
+
+    void beginPuzzle(const std::string& puzzle);
+    // Close the puzzle span; returns its duration in microseconds
+    double endPuzzle(bool solved);
+    // Drop the events of the puzzle just ended (outlier filtering)
+    void discardPuzzle() { events.resize(puzzleFirst); }
+
+    void beginKernel() { kernelStart = Clock::now(); }
+    void endKernel(bool solved, int nakedSingles, int hiddenSingles);
+
+    void beginStep(int step, const SolveProgress& progress) override;
+    void endStep(int step, bool changed, const SolveProgress& progress) override;
+
+    bool empty() const { return events.empty(); }
+    void write(std::ostream& out) const;
+    std::string json() const;
+
+private:
+    struct Event {
+        std::string name;
+        const char* cat;
+        double ts, dur;      // microseconds since origin
+        std::string args;    // JSON object body
+    };
+    double micros(Clock::time_point t) const {
+        return std::chrono::duration<double, std::micro>(t - origin).count();
+    }
+
+    Clock::time_point origin, puzzleStart, kernelStart, stepStart;
+    SolveProgress stepProgress;
+    std::string puzzle;
+    size_t puzzleFirst = 0;
+    std::vector<Event> events;
+};
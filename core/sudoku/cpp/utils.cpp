@@ -1,20 +1,26 @@
 #include "solver.h"
+#include "bitslice.h"
+#include <bit>
 #include <bitset>
 
-// Check if current grid state satisfies sudoku constraints
+// Check if current grid state satisfies sudoku constraints. The size is
+// taken from the grid; boxes are square, so N must be a perfect square.
 bool isValid(const std::vector<std::vector<int>>& grid) {
     // Check dimensions
-    if (grid.size() != 9) return false;
+    const int N = grid.size();
+    int B = 1;
+    while (B * B < N) B++;
+    if (B * B != N || N > 63) return false;
     for (const auto& row : grid) {
-        if (row.size() != 9) return false;
+        if ((int)row.size() != N) return false;
     }
     
     // Check rows
-    for (int r = 0; r < 9; r++) {
-        std::bitset<10> seen;
-        for (int c = 0; c < 9; c++) {
+    for (int r = 0; r < N; r++) {
+        std::bitset<64> seen;
+        for (int c = 0; c < N; c++) {
             int val = grid[r][c];
-            if (val < 0 || val > 9) return false;
+            if (val < 0 || val > N) return false;
             if (val != 0) {
                 if (seen[val]) return false;  // Duplicate in row
                 seen[val] = 1;
@@ -23,9 +29,9 @@ bool isValid(const std::vector<std::vector<int>>& grid) {
     }
     
     // Check columns
-    for (int c = 0; c < 9; c++) {
-        std::bitset<10> seen;
-        for (int r = 0; r < 9; r++) {
+    for (int c = 0; c < N; c++) {
+        std::bitset<64> seen;
+        for (int r = 0; r < N; r++) {
             int val = grid[r][c];
             if (val != 0) {
                 if (seen[val]) return false;  // Duplicate in column
@@ -34,14 +40,14 @@ bool isValid(const std::vector<std::vector<int>>& grid) {
         }
     }
     
-    // Check 3x3 boxes
-    for (int box = 0; box < 9; box++) {
-        std::bitset<10> seen;
-        int br = (box / 3) * 3;
-        int bc = (box % 3) * 3;
+    // Check boxes
+    for (int box = 0; box < N; box++) {
+        std::bitset<64> seen;
+        int br = (box / B) * B;
+        int bc = (box % B) * B;
         
-        for (int i = 0; i < 3; i++) {
-            for (int j = 0; j < 3; j++) {
+        for (int i = 0; i < B; i++) {
+            for (int j = 0; j < B; j++) {
                 int val = grid[br + i][bc + j];
                 if (val != 0) {
                     if (seen[val]) return false;  // Duplicate in box
@@ -58,13 +64,218 @@ bool isValid(const std::vector<std::vector<int>>& grid) {
 
 bool isFilled(const std::vector<std::vector<int>>& grid) {
     // Check rows
-    for (int r = 0; r < 9; r++) {
-        for (int c = 0; c < 9; c++) {
-            int val = grid[r][c];
+    for (const auto& row : grid) {
+        for (int val : row) {
             if (val == 0) 
                 return false;
         }
     }
        
     return true;
-}
\ No newline at end of file
+}
+
+
+namespace {
+
+// Depth-first search over candidate masks with singles propagation, for
+// counting solutions
+template<typename Geo>
+struct Search {
+    static constexpr int N = Geo::N;
+    using Word = typename Geo::Word;
+    using Board = std::array<Word, Geo::NN>;   // candidate bits 1..N; a single bit is a placed digit
+    static constexpr Word DIGITS = Word(Geo::Mask::ALL & ~Word(1));
+
+    // A board whose placed cells are already removed from their peers, so
+    // a branch only propagates from the cell it sets
+    struct State {
+        Board b;
+        std::bitset<Geo::NN> placed;
+    };
+
+    // Naked and hidden singles to a fixpoint, starting from the cells on
+    // the stack; false on a contradiction
+    static bool propagate(State& s, std::array<int, Geo::NN>& stack, int top) {
+        const auto& geo = Geo::get();
+        auto& b = s.b;
+        while (top) {
+            while (top) {
+                const int cell = stack[--top];
+                const Word w = b[cell];
+                for (int peer : geo.peers[cell]) {
+                    if (!(b[peer] & w)) continue;
+                    if (!(b[peer] &= Word(~w))) return false;
+                    if (!s.placed[peer] && std::popcount(b[peer]) == 1) {
+                        s.placed[peer] = 1;
+                        stack[top++] = peer;
+                    }
+                }
+            }
+            for (const auto& house : geo.houseCells) {
+                Word one = 0, two = 0, solved = 0;
+                for (int cell : house) {
+                    two |= one & b[cell];
+                    one |= b[cell];
+                    if (s.placed[cell]) solved |= b[cell];
+                }
+                if (one != DIGITS) return false;
+                for (Word hidden = one & ~two & ~solved; hidden; hidden &= hidden - 1) {
+                    const Word d = Word(1) << std::countr_zero(hidden);
+                    for (int cell : house) {
+                        if (!(b[cell] & d)) continue;
+                        b[cell] = d;
+                        s.placed[cell] = 1;
+                        stack[top++] = cell;
+                        break;
+                    }
+                }
+            }
+        }
+        return true;
+    }
+
+    // Solutions of a propagated state up to limit, branching on a cell
+    // with fewest candidates; the first one found goes to *first
+    static int count(const State& s, int limit, Board* first) {
+        int best = -1, fewest = N + 1;
+        for (int cell = 0; cell < Geo::NN && fewest > 2; cell++) {
+            const int k = std::popcount(s.b[cell]);
+            if (k > 1 && k < fewest) {
+                best = cell;
+                fewest = k;
+            }
+        }
+        if (best < 0) {
+            if (first) *first = s.b;
+            return 1;
+        }
+        int found = 0;
+        std::array<int, Geo::NN> stack;
+        for (Word w = s.b[best]; w && found < limit; w &= w - 1) {
+            State next = s;
+            next.b[best] = Word(1) << std::countr_zero(w);
+            next.placed[best] = 1;
+            stack[0] = best;
+            if (propagate(next, stack, 1)) found += count(next, limit - found, found ? nullptr : first);
+        }
+        return found;
+    }
+
+    static int count(const Board& b, int limit, Board* first = nullptr) {
+        State s{b, {}};
+        std::array<int, Geo::NN> stack;
+        int top = 0;
+        for (int cell = 0; cell < Geo::NN; cell++) {
+            if (!b[cell]) return 0;
+            if (std::popcount(b[cell]) != 1) continue;
+            s.placed[cell] = 1;
+            stack[top++] = cell;
+        }
+        return propagate(s, stack, top) ? count(s, limit, first) : 0;
+    }
+};
+
+// Each trial removes one clue and forbids its value in its cell, so it is
+// satisfiable exactly when the clue is needed. Up to 64 trials share one
+// bit-sliced board built from the full puzzle: propagation refutes most
+// redundant clues for all lanes at once, and only lanes left open are
+// searched.
+template<typename Geo>
+ClueAnalysis analyze(const std::string& puzzle) {
+    using S = Search<Geo>;
+    using Word = typename S::Word;
+    constexpr int N = Geo::N;
+    const auto& geo = Geo::get();
+
+    ClueAnalysis a;
+    typename S::Board board, solution;
+    std::vector<int> value(Geo::NN);
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        value[cell] = Geo::fromChar(puzzle[cell]);
+        if (value[cell] > N) return a;
+        board[cell] = value[cell] ? Word(Word(1) << value[cell]) : S::DIGITS;
+        if (value[cell]) a.clues.push_back(cell);
+    }
+    a.solutions = S::count(board, 2, &solution);
+    if (a.solutions != 1) return a;
+
+    // Clue values seen by each cell, counted so a lane can drop one clue
+    std::vector<std::array<uint8_t, N + 1>> seen(Geo::NN);
+    for (int clue : a.clues)
+        for (int peer : geo.peers[clue]) seen[peer][value[clue]]++;
+    std::array<Word, Geo::NN> masks{};
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        masks[cell] = board[cell];
+        if (value[cell]) continue;
+        for (int n = 1; n <= N; n++)
+            if (seen[cell][n]) masks[cell] &= Word(~(Word(1) << n));
+    }
+
+    for (size_t base = 0; base < a.clues.size(); base += 64) {
+        const int lanes = std::min<size_t>(64, a.clues.size() - base);
+        SlicedBoard<Geo> sliced(masks);
+        for (int k = 0; k < lanes; k++) {
+            const int clue = a.clues[base + k], v = value[clue];
+            const Word bit = Word(1) << v;
+            Word open = S::DIGITS & ~bit;
+            for (int n = 1; n <= N; n++)
+                if (seen[clue][n]) open &= Word(~(Word(1) << n));
+            sliced.setCandidates(k, clue, open);
+            for (int peer : geo.peers[clue])
+                if (!value[peer] && seen[peer][v] == 1) sliced.setCandidates(k, peer, masks[peer] | bit);
+        }
+
+        const uint64_t all = lanes == 64 ? ~uint64_t(0) : (uint64_t(1) << lanes) - 1;
+        const uint64_t dead = sliced.propagate(S::DIGITS, all);
+        for (int k = 0; k < lanes; k++) {
+            bool redundant = dead >> k & 1;
+            if (!redundant) {
+                typename S::Board trial;
+                for (int cell = 0; cell < Geo::NN; cell++) trial[cell] = sliced.candidates(k, cell);
+                redundant = S::count(trial, 1) == 0;
+            }
+            if (redundant) a.redundant.push_back(a.clues[base + k]);
+        }
+    }
+    return a;
+}
+
+template<typename Geo>
+int solutions(const std::string& puzzle, std::vector<std::vector<int>>* grid) {
+    using S = Search<Geo>;
+    constexpr int N = Geo::N;
+    typename S::Board board, first;
+    for (int cell = 0; cell < Geo::NN; cell++) {
+        const int v = Geo::fromChar(puzzle[cell]);
+        if (v > N) return 0;
+        board[cell] = v ? typename S::Word(typename S::Word(1) << v) : S::DIGITS;
+    }
+    const int found = S::count(board, 2, &first);
+    if (found && grid) {
+        grid->assign(N, std::vector<int>(N));
+        for (int cell = 0; cell < Geo::NN; cell++) (*grid)[cell / N][cell % N] = std::countr_zero(first[cell]);
+    }
+    return found;
+}
+
+} // namespace
+
+int countSolutions(const std::string& puzzle, std::vector<std::vector<int>>* solution) {
+    switch (puzzle.size()) {
+        case 16:  return solutions<Geometry<2, 2>>(puzzle, solution);
+        case 81:  return solutions<Geometry<3, 3>>(puzzle, solution);
+        case 256: return solutions<Geometry<4, 4>>(puzzle, solution);
+        case 625: return solutions<Geometry<5, 5>>(puzzle, solution);
+    }
+    return 0;
+}
+
+ClueAnalysis analyzeClues(const std::string& puzzle) {
+    switch (puzzle.size()) {
+        case 16:  return analyze<Geometry<2, 2>>(puzzle);
+        case 81:  return analyze<Geometry<3, 3>>(puzzle);
+        case 256: return analyze<Geometry<4, 4>>(puzzle);
+        case 625: return analyze<Geometry<5, 5>>(puzzle);
+    }
+    return {};
+}